@@ -0,0 +1,463 @@
+#include "immintrin.h" // AVX2, 256 bit operations (8 floats / 8 int32)
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. Compare-Exchange: _mm256_min_ps / _mm256_max_ps (the pair used by the clamp in
+ *    01_conditional_code) sort 8 independent lanes of two registers in one step.
+ * 2. 8x8 Sorting Network: 19 compare-exchanges across 8 registers sort every column of a
+ *    64-element block, and an 8x8 transpose turns the columns into 8 sorted runs of 8.
+ * 3. Bitonic Merge: two sorted registers are merged in-register (reverse, min/max, then three
+ *    permute + min/max + blend stages), which drives a streaming merge of two sorted arrays.
+ * 4. Full Sort: runs of 8 are merged bottom-up, ping-ponging between the input and a buffer.
+ *    The same code sorts float keys, int32 keys, and (key, int32 value) pairs.
+ *
+ * Focus:
+ * - Shows how branchless min/max replaces the data-dependent branches of std::sort.
+ * - Compares the SIMD sort with std::sort across sizes and input distributions.
+ *
+ * Note: keys must not be NaN (std::sort has the same requirement), and the key-value sort is
+ * not stable.
+ */
+
+//--------- Key operations, one struct per key type -------------//
+
+struct FloatKeys {
+    typedef float Key;
+    typedef __m256 Reg;
+
+    static Reg load(const Key* p) { return _mm256_loadu_ps(p); }
+    static void store(Key* p, Reg r) { _mm256_storeu_ps(p, r); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_ps(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_ps(a, b); }
+    static Reg permute(Reg r, __m256i idx) { return _mm256_permutevar8x32_ps(r, idx); }
+    static __m256i greater(Reg a, Reg b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    static Reg select(Reg a, Reg b, __m256i mask) { return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(mask)); }
+    template<int Imm>
+    static Reg blend(Reg a, Reg b) { return _mm256_blend_ps(a, b, Imm); }
+};
+
+struct Int32Keys {
+    typedef int32_t Key;
+    typedef __m256i Reg;
+
+    static Reg load(const Key* p) { return _mm256_loadu_si256((const __m256i*)p); }
+    static void store(Key* p, Reg r) { _mm256_storeu_si256((__m256i*)p, r); }
+    static Reg min(Reg a, Reg b) { return _mm256_min_epi32(a, b); }
+    static Reg max(Reg a, Reg b) { return _mm256_max_epi32(a, b); }
+    static Reg permute(Reg r, __m256i idx) { return _mm256_permutevar8x32_epi32(r, idx); }
+    static __m256i greater(Reg a, Reg b) { return _mm256_cmpgt_epi32(a, b); }
+    static Reg select(Reg a, Reg b, __m256i mask) { return _mm256_blendv_epi8(a, b, mask); }
+    template<int Imm>
+    static Reg blend(Reg a, Reg b) { return _mm256_blend_epi32(a, b, Imm); }
+};
+
+// Transpose 8 rows of 8 floats so that register i holds column i
+void transpose8x8(__m256* r) {
+    __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+void transpose8x8(__m256i* r) {
+    __m256 f[8];
+    for (int i = 0; i < 8; ++i) f[i] = _mm256_castsi256_ps(r[i]);
+    transpose8x8(f);
+    for (int i = 0; i < 8; ++i) r[i] = _mm256_castps_si256(f[i]);
+}
+
+//--------- Element operations: keys only, or keys carrying an int32 value -------------//
+
+template<typename K>
+struct KeysOnly {
+    typedef typename K::Key Key;
+    typedef typename K::Reg Reg;
+    typedef Key* Ptr;
+
+    struct Scratch {
+        Key k[8];
+        Ptr ptr() { return k; }
+    };
+
+    static Reg load(Ptr p, size_t i) { return K::load(p + i); }
+    static void store(Ptr p, size_t i, Reg r) { K::store(p + i, r); }
+    static Key key(Ptr p, size_t i) { return p[i]; }
+    static void copy(Ptr dst, size_t di, Ptr src, size_t si) { dst[di] = src[si]; }
+    static void copyRange(Ptr dst, Ptr src, size_t n) { std::copy(src, src + n, dst); }
+
+    // a receives the lane-wise minimum, b the lane-wise maximum
+    static void compareExchange(Reg& a, Reg& b) {
+        Reg lo = K::min(a, b);
+        b = K::max(a, b);
+        a = lo;
+    }
+
+    // Compare each lane with its partner given by idx; lanes set in Imm keep the larger value
+    template<int Imm>
+    static Reg partnerExchange(Reg x, __m256i idx) {
+        Reg p = K::permute(x, idx);
+        return K::template blend<Imm>(K::min(x, p), K::max(x, p));
+    }
+
+    static Reg reverse(Reg x) { return K::permute(x, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+    static void transpose(Reg* r) { transpose8x8(r); }
+};
+
+template<typename K>
+struct KeyValue {
+    typedef typename K::Key Key;
+    struct Reg { typename K::Reg k; __m256i v; };
+    struct Ptr { Key* k; int32_t* v; };
+
+    struct Scratch {
+        Key k[8];
+        int32_t v[8];
+        Ptr ptr() { Ptr p = { k, v }; return p; }
+    };
+
+    static Reg load(Ptr p, size_t i) {
+        Reg r = { K::load(p.k + i), _mm256_loadu_si256((const __m256i*)(p.v + i)) };
+        return r;
+    }
+    static void store(Ptr p, size_t i, Reg r) {
+        K::store(p.k + i, r.k);
+        _mm256_storeu_si256((__m256i*)(p.v + i), r.v);
+    }
+    static Key key(Ptr p, size_t i) { return p.k[i]; }
+    static void copy(Ptr dst, size_t di, Ptr src, size_t si) {
+        dst.k[di] = src.k[si];
+        dst.v[di] = src.v[si];
+    }
+    static void copyRange(Ptr dst, Ptr src, size_t n) {
+        std::copy(src.k, src.k + n, dst.k);
+        std::copy(src.v, src.v + n, dst.v);
+    }
+
+    // Pairs move together: the key comparison picks which whole (key, value) lane goes where
+    static void compareExchange(Reg& a, Reg& b) {
+        __m256i swap = K::greater(a.k, b.k);
+        Reg lo = { K::select(a.k, b.k, swap), _mm256_blendv_epi8(a.v, b.v, swap) };
+        b.k = K::select(b.k, a.k, swap);
+        b.v = _mm256_blendv_epi8(b.v, a.v, swap);
+        a = lo;
+    }
+
+    // Both lanes of a pair must agree on swapping, so ties (equal keys) never swap on either side
+    template<int Imm>
+    static Reg partnerExchange(Reg x, __m256i idx) {
+        Reg p = { K::permute(x.k, idx), _mm256_permutevar8x32_epi32(x.v, idx) };
+        __m256i swap = _mm256_blend_epi32(K::greater(x.k, p.k), K::greater(p.k, x.k), Imm);
+        Reg r = { K::select(x.k, p.k, swap), _mm256_blendv_epi8(x.v, p.v, swap) };
+        return r;
+    }
+
+    static Reg reverse(Reg x) {
+        __m256i idx = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+        Reg r = { K::permute(x.k, idx), _mm256_permutevar8x32_epi32(x.v, idx) };
+        return r;
+    }
+    static void transpose(Reg* r) {
+        typename K::Reg k[8];
+        __m256i v[8];
+        for (int i = 0; i < 8; ++i) { k[i] = r[i].k; v[i] = r[i].v; }
+        transpose8x8(k);
+        transpose8x8(v);
+        for (int i = 0; i < 8; ++i) { r[i].k = k[i]; r[i].v = v[i]; }
+    }
+};
+
+//--------- Sorting network and bitonic merge -------------//
+
+// Sorts each of the 8 columns of r[0..7] with the optimal 19 comparator network for 8 inputs
+template<typename Ops>
+void sortColumns(typename Ops::Reg* r) {
+    static const int network[19][2] = {
+        {0, 2}, {1, 3}, {4, 6}, {5, 7},
+        {0, 4}, {1, 5}, {2, 6}, {3, 7},
+        {0, 1}, {2, 3}, {4, 5}, {6, 7},
+        {2, 4}, {3, 5},
+        {1, 4}, {3, 6},
+        {1, 2}, {3, 4}, {5, 6}
+    };
+    for (int c = 0; c < 19; ++c) {
+        Ops::compareExchange(r[network[c][0]], r[network[c][1]]);
+    }
+}
+
+// Merges two sorted registers: afterwards a holds the 8 smallest and b the 8 largest, both sorted
+template<typename Ops>
+void bitonicMerge16(typename Ops::Reg& a, typename Ops::Reg& b) {
+    const __m256i half = _mm256_setr_epi32(4, 5, 6, 7, 0, 1, 2, 3);
+    const __m256i pair = _mm256_setr_epi32(2, 3, 0, 1, 6, 7, 4, 5);
+    const __m256i odd = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 7, 6);
+
+    b = Ops::reverse(b);
+    Ops::compareExchange(a, b);
+
+    a = Ops::template partnerExchange<0xF0>(a, half);
+    b = Ops::template partnerExchange<0xF0>(b, half);
+    a = Ops::template partnerExchange<0xCC>(a, pair);
+    b = Ops::template partnerExchange<0xCC>(b, pair);
+    a = Ops::template partnerExchange<0xAA>(a, odd);
+    b = Ops::template partnerExchange<0xAA>(b, odd);
+}
+
+// Scalar insertion sort of src[begin, end)
+template<typename Ops>
+void insertionSort(typename Ops::Ptr p, size_t begin, size_t end) {
+    typename Ops::Scratch tmp;
+    for (size_t i = begin + 1; i < end; ++i) {
+        Ops::copy(tmp.ptr(), 0, p, i);
+        size_t j = i;
+        while (j > begin && Ops::key(p, j - 1) > tmp.k[0]) {
+            Ops::copy(p, j, p, j - 1);
+            --j;
+        }
+        Ops::copy(p, j, tmp.ptr(), 0);
+    }
+}
+
+/*
+ * Merge src[aBegin, aEnd) and src[aEnd, bEnd) into dst[aBegin, bEnd).
+ * The vector loop always refills from the run with the smaller head, which guarantees that the
+ * 8 values written out are no larger than anything still unread. Once that run has fewer than
+ * 8 elements left, the leftover register and both tails finish with a scalar merge.
+ */
+template<typename Ops>
+void mergeRuns(typename Ops::Ptr src, size_t aBegin, size_t aEnd, size_t bEnd, typename Ops::Ptr dst) {
+    typedef typename Ops::Reg Reg;
+    size_t ia = aBegin, ib = aEnd, out = aBegin;
+    typename Ops::Scratch carry;
+    size_t carryLen = 0;
+
+    if (aEnd - aBegin >= 8 && bEnd - aEnd >= 8) {
+        Reg lo = Ops::load(src, ia);
+        Reg hi = Ops::load(src, ib);
+        ia += 8;
+        ib += 8;
+        for (;;) {
+            bitonicMerge16<Ops>(lo, hi);
+            Ops::store(dst, out, lo);
+            out += 8;
+
+            bool fromA = ia < aEnd && (ib >= bEnd || Ops::key(src, ia) <= Ops::key(src, ib));
+            size_t& next = fromA ? ia : ib;
+            size_t end = fromA ? aEnd : bEnd;
+            if (end - next < 8) break;
+            lo = Ops::load(src, next);
+            next += 8;
+        }
+        Ops::store(carry.ptr(), 0, hi);
+        carryLen = 8;
+    }
+
+    // Scalar three-way merge of carry, the tail of a and the tail of b
+    typename Ops::Ptr carryPtr = carry.ptr();
+    size_t ic = 0;
+    while (out < bEnd) {
+        bool hasC = ic < carryLen, hasA = ia < aEnd, hasB = ib < bEnd;
+        if (hasC && (!hasA || Ops::key(carryPtr, ic) <= Ops::key(src, ia)) &&
+                (!hasB || Ops::key(carryPtr, ic) <= Ops::key(src, ib))) {
+            Ops::copy(dst, out++, carryPtr, ic++);
+        } else if (hasA && (!hasB || Ops::key(src, ia) <= Ops::key(src, ib))) {
+            Ops::copy(dst, out++, src, ia++);
+        } else {
+            Ops::copy(dst, out++, src, ib++);
+        }
+    }
+}
+
+// Sorts data[0, n) using buffer (also n elements) as merge scratch space
+template<typename Ops>
+void simdSort(typename Ops::Ptr data, typename Ops::Ptr buffer, size_t n) {
+    typedef typename Ops::Reg Reg;
+
+    // Phase 1: every 64-element block becomes 8 sorted runs of 8
+    size_t blocked = n - n % 64;
+    for (size_t base = 0; base < blocked; base += 64) {
+        Reg r[8];
+        for (int i = 0; i < 8; ++i) r[i] = Ops::load(data, base + 8 * i);
+        sortColumns<Ops>(r);
+        Ops::transpose(r);
+        for (int i = 0; i < 8; ++i) Ops::store(data, base + 8 * i, r[i]);
+    }
+    for (size_t base = blocked; base < n; base += 8) {
+        insertionSort<Ops>(data, base, std::min(base + 8, n));
+    }
+
+    // Phase 2: bottom-up merge passes, alternating between data and buffer
+    typename Ops::Ptr src = data, dst = buffer;
+    bool inBuffer = false;
+    for (size_t width = 8; width < n; width *= 2) {
+        for (size_t lo = 0; lo < n; lo += 2 * width) {
+            size_t mid = std::min(lo + width, n);
+            size_t hi = std::min(lo + 2 * width, n);
+            mergeRuns<Ops>(src, lo, mid, hi, dst);
+        }
+        std::swap(src, dst);
+        inBuffer = !inBuffer;
+    }
+    if (inBuffer) Ops::copyRange(data, buffer, n);
+}
+
+//--------- Public entry points -------------//
+
+void simdSort(float* data, float* buffer, size_t n) {
+    simdSort<KeysOnly<FloatKeys> >(data, buffer, n);
+}
+
+void simdSort(int32_t* data, int32_t* buffer, size_t n) {
+    simdSort<KeysOnly<Int32Keys> >(data, buffer, n);
+}
+
+void simdSortKeyValue(float* keys, int32_t* values, float* keyBuffer, int32_t* valueBuffer, size_t n) {
+    KeyValue<FloatKeys>::Ptr data = { keys, values }, buffer = { keyBuffer, valueBuffer };
+    simdSort<KeyValue<FloatKeys> >(data, buffer, n);
+}
+
+void simdSortKeyValue(int32_t* keys, int32_t* values, int32_t* keyBuffer, int32_t* valueBuffer, size_t n) {
+    KeyValue<Int32Keys>::Ptr data = { keys, values }, buffer = { keyBuffer, valueBuffer };
+    simdSort<KeyValue<Int32Keys> >(data, buffer, n);
+}
+
+//--------- Benchmark -------------//
+
+enum Distribution { UNIFORM, SORTED, REVERSED, FEW_UNIQUE, NEARLY_SORTED };
+const char* distributionNames[] = { "uniform", "sorted", "reversed", "few unique", "nearly sorted" };
+
+template<typename T>
+void fillData(std::vector<T>& v, Distribution dist, std::mt19937& rng) {
+    std::uniform_int_distribution<int32_t> any(-1000000000, 1000000000);
+    std::uniform_int_distribution<int32_t> few(0, 15);
+    for (size_t i = 0; i < v.size(); ++i) {
+        v[i] = static_cast<T>(dist == FEW_UNIQUE ? few(rng) : any(rng));
+    }
+    if (dist == SORTED || dist == NEARLY_SORTED) std::sort(v.begin(), v.end());
+    if (dist == REVERSED) std::sort(v.begin(), v.end(), [](T a, T b) { return a > b; });
+    if (dist == NEARLY_SORTED) {
+        std::uniform_int_distribution<size_t> pos(0, v.size() - 1);
+        for (size_t i = 0; i < v.size() / 100 + 1; ++i) std::swap(v[pos(rng)], v[pos(rng)]);
+    }
+}
+
+// Runs f on a fresh copy of input `repeats` times and returns the average time in ms
+template<typename T, typename Func>
+double timeSort(const std::vector<T>& input, std::vector<T>& work, int repeats, Func f) {
+    double total = 0;
+    for (int r = 0; r < repeats; ++r) {
+        work = input;
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto stop = std::chrono::high_resolution_clock::now();
+        total += std::chrono::duration<double, std::milli>(stop - start).count();
+    }
+    return total / repeats;
+}
+
+template<typename T>
+bool benchmarkKeys(const char* typeName, const std::vector<size_t>& sizes, std::mt19937& rng) {
+    std::cout << "----------- " << typeName << " keys --------------------------------------" << std::endl;
+    bool ok = true;
+    for (size_t n : sizes) {
+        int repeats = static_cast<int>(std::max<size_t>(1, (1 << 22) / n));
+        std::vector<T> input(n), expected, work(n), buffer(n);
+        for (int d = 0; d <= NEARLY_SORTED; ++d) {
+            fillData(input, static_cast<Distribution>(d), rng);
+            double stdMs = timeSort(input, expected, repeats, [&] { std::sort(expected.begin(), expected.end()); });
+            double simdMs = timeSort(input, work, repeats, [&] { simdSort(work.data(), buffer.data(), n); });
+            bool correct = work == expected;
+            ok = ok && correct;
+            std::cout << "n=" << n << " " << distributionNames[d] << ": std::sort " << stdMs
+                      << " ms, SIMD sort " << simdMs << " ms, speedup " << stdMs / simdMs << "x"
+                      << (correct ? "" : "  MISMATCH") << std::endl;
+        }
+    }
+    return ok;
+}
+
+template<typename T>
+bool benchmarkKeyValue(const char* typeName, const std::vector<size_t>& sizes, std::mt19937& rng) {
+    std::cout << "----------- " << typeName << " key-value pairs ---------------------------" << std::endl;
+    bool ok = true;
+    for (size_t n : sizes) {
+        int repeats = static_cast<int>(std::max<size_t>(1, (1 << 21) / n));
+        std::vector<T> keys(n), keyWork(n), keyBuffer(n);
+        std::vector<int32_t> valueWork(n), valueBuffer(n);
+        std::vector<std::pair<T, int32_t> > pairs(n), pairWork;
+        fillData(keys, UNIFORM, rng);
+        for (size_t i = 0; i < n; ++i) pairs[i] = std::make_pair(keys[i], static_cast<int32_t>(i));
+
+        auto byKey = [](const std::pair<T, int32_t>& a, const std::pair<T, int32_t>& b) { return a.first < b.first; };
+        double stdMs = timeSort(pairs, pairWork, repeats, [&] { std::sort(pairWork.begin(), pairWork.end(), byKey); });
+        double simdMs = 0;
+        for (int r = 0; r < repeats; ++r) {
+            keyWork = keys;
+            for (size_t i = 0; i < n; ++i) valueWork[i] = static_cast<int32_t>(i);
+            auto start = std::chrono::high_resolution_clock::now();
+            simdSortKeyValue(keyWork.data(), valueWork.data(), keyBuffer.data(), valueBuffer.data(), n);
+            auto stop = std::chrono::high_resolution_clock::now();
+            simdMs += std::chrono::duration<double, std::milli>(stop - start).count();
+        }
+        simdMs /= repeats;
+
+        // Keys must be sorted and every value must still sit next to its original key
+        bool correct = std::is_sorted(keyWork.begin(), keyWork.end());
+        std::vector<bool> seen(n, false);
+        for (size_t i = 0; i < n && correct; ++i) {
+            int32_t v = valueWork[i];
+            correct = v >= 0 && static_cast<size_t>(v) < n && !seen[v] && keys[v] == keyWork[i];
+            if (correct) seen[v] = true;
+        }
+        ok = ok && correct;
+        std::cout << "n=" << n << " uniform: std::sort (pairs) " << stdMs << " ms, SIMD sort " << simdMs
+                  << " ms, speedup " << stdMs / simdMs << "x" << (correct ? "" : "  MISMATCH") << std::endl;
+    }
+    return ok;
+}
+
+int main() {
+    std::mt19937 rng(42);
+
+    // Odd sizes exercise the scalar tails of the block sort and the merge
+    std::vector<size_t> sizes = { 1000, 1 << 12, 100003, 1 << 20, 1 << 22 };
+
+    bool ok = true;
+    ok = benchmarkKeys<float>("float", sizes, rng) && ok;
+    ok = benchmarkKeys<int32_t>("int32", sizes, rng) && ok;
+    ok = benchmarkKeyValue<float>("float", sizes, rng) && ok;
+    ok = benchmarkKeyValue<int32_t>("int32", sizes, rng) && ok;
+
+    if (!ok) {
+        std::cerr << "SIMD sort produced a wrong result." << std::endl;
+        return 1;
+    }
+    return 0;
+}
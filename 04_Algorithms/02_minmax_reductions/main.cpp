@@ -0,0 +1,351 @@
+#include "immintrin.h" // AVX2, 256 bit operations (8 floats / 8 int32)
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. Value Reductions: min/max of an array with several independent _mm256_min_ps /
+ *    _mm256_max_ps accumulators, folded into one value at the end.
+ * 2. Index Tracking: argmin/argmax keep a value register and an index register per accumulator.
+ *    A compare mask decides, lane by lane, whether the new value and its index replace the
+ *    current best (_mm256_blendv_ps / _mm256_blendv_epi8).
+ * 3. Cross-Lane Reduction: the 8 lane winners are combined with a deterministic tie-break
+ *    (the lowest index wins), so the result matches std::min_element / std::max_element.
+ * 4. NaN Handling: IGNORE_NAN skips NaNs, PROPAGATE_NAN returns the first NaN as the result.
+ *
+ * Focus:
+ * - Compares SIMD reductions with std::min_element / std::max_element on an array that fits
+ *   in L1 and an array that spills to DRAM.
+ */
+
+enum NanPolicy { IGNORE_NAN, PROPAGATE_NAN };
+
+// index is -1 when there is no result (empty input, or only NaNs with IGNORE_NAN).
+// Lanes track indices as int32, so inputs must have fewer than 2^31 elements.
+template<typename T>
+struct ArgResult {
+    T value;
+    long index;
+};
+
+//--------- Scalar helpers shared by the tails and the cross-lane reduction -------------//
+
+template<bool IsMax>
+void considerCandidate(ArgResult<float>& best, float value, long index, NanPolicy policy) {
+    if (index < 0) return;
+    bool valueNan = std::isnan(value);
+    if (valueNan && policy == IGNORE_NAN) return;
+    if (best.index < 0) {
+        best.value = value;
+        best.index = index;
+        return;
+    }
+    bool bestNan = std::isnan(best.value);
+    bool take;
+    if (valueNan || bestNan) {
+        // PROPAGATE_NAN: a NaN beats any number, and among NaNs the lowest index wins
+        take = valueNan && (!bestNan || index < best.index);
+    } else if (value == best.value) {
+        take = index < best.index;
+    } else {
+        take = IsMax ? value > best.value : value < best.value;
+    }
+    if (take) {
+        best.value = value;
+        best.index = index;
+    }
+}
+
+template<bool IsMax>
+void considerCandidate(ArgResult<int32_t>& best, int32_t value, long index) {
+    if (index < 0) return;
+    bool take = best.index < 0 ||
+        (value == best.value ? index < best.index : (IsMax ? value > best.value : value < best.value));
+    if (take) {
+        best.value = value;
+        best.index = index;
+    }
+}
+
+//--------- argmin / argmax -------------//
+
+/*
+ * Replace a lane when the new value is strictly better (so equal values keep the earlier index).
+ * _CMP_NGE_UQ ("not >=") is also true when either side is NaN:
+ * - IGNORE_NAN: AND with "v is ordered", so a NaN never wins but a number replaces a NaN that
+ *   only got into the lane because the lane started on one.
+ * - PROPAGATE_NAN: AND with "best is ordered", so the first NaN of a lane sticks.
+ */
+template<bool IsMax>
+inline __m256 replaceMask(__m256 v, __m256 best, NanPolicy policy) {
+    __m256 better = IsMax ? _mm256_cmp_ps(v, best, _CMP_NLE_UQ) : _mm256_cmp_ps(v, best, _CMP_NGE_UQ);
+    __m256 ordered = policy == IGNORE_NAN ? _mm256_cmp_ps(v, v, _CMP_ORD_Q) : _mm256_cmp_ps(best, best, _CMP_ORD_Q);
+    return _mm256_and_ps(better, ordered);
+}
+
+template<bool IsMax>
+ArgResult<float> simdArgExtreme(const float* data, size_t n, NanPolicy policy) {
+    ArgResult<float> best = { std::numeric_limits<float>::quiet_NaN(), -1 };
+    size_t i = 0;
+    if (n >= 16) {
+        // Two accumulators hide the latency of the compare + blend chain
+        __m256 valA = _mm256_loadu_ps(data), valB = _mm256_loadu_ps(data + 8);
+        __m256i idxA = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i idxB = _mm256_add_epi32(idxA, _mm256_set1_epi32(8));
+        __m256i curA = idxA, curB = idxB;
+        const __m256i step = _mm256_set1_epi32(16);
+        for (i = 16; i + 16 <= n; i += 16) {
+            curA = _mm256_add_epi32(curA, step);
+            curB = _mm256_add_epi32(curB, step);
+            __m256 vA = _mm256_loadu_ps(data + i);
+            __m256 vB = _mm256_loadu_ps(data + i + 8);
+            __m256 maskA = replaceMask<IsMax>(vA, valA, policy);
+            __m256 maskB = replaceMask<IsMax>(vB, valB, policy);
+            valA = _mm256_blendv_ps(valA, vA, maskA);
+            valB = _mm256_blendv_ps(valB, vB, maskB);
+            idxA = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(idxA), _mm256_castsi256_ps(curA), maskA));
+            idxB = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(idxB), _mm256_castsi256_ps(curB), maskB));
+        }
+
+        // Cross-lane reduction over the 16 lane winners, lowest index breaks ties
+        union { __m256 v; float f[8]; } va, vb;
+        union { __m256i v; int32_t x[8]; } ia, ib;
+        va.v = valA; vb.v = valB; ia.v = idxA; ib.v = idxB;
+        for (int lane = 0; lane < 8; ++lane) {
+            considerCandidate<IsMax>(best, va.f[lane], ia.x[lane], policy);
+            considerCandidate<IsMax>(best, vb.f[lane], ib.x[lane], policy);
+        }
+    }
+    for (; i < n; ++i) {
+        considerCandidate<IsMax>(best, data[i], static_cast<long>(i), policy);
+    }
+    return best;
+}
+
+template<bool IsMax>
+ArgResult<int32_t> simdArgExtreme(const int32_t* data, size_t n) {
+    ArgResult<int32_t> best = { 0, -1 };
+    size_t i = 0;
+    if (n >= 16) {
+        __m256i valA = _mm256_loadu_si256((const __m256i*)data);
+        __m256i valB = _mm256_loadu_si256((const __m256i*)(data + 8));
+        __m256i idxA = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i idxB = _mm256_add_epi32(idxA, _mm256_set1_epi32(8));
+        __m256i curA = idxA, curB = idxB;
+        const __m256i step = _mm256_set1_epi32(16);
+        for (i = 16; i + 16 <= n; i += 16) {
+            curA = _mm256_add_epi32(curA, step);
+            curB = _mm256_add_epi32(curB, step);
+            __m256i vA = _mm256_loadu_si256((const __m256i*)(data + i));
+            __m256i vB = _mm256_loadu_si256((const __m256i*)(data + i + 8));
+            __m256i maskA = IsMax ? _mm256_cmpgt_epi32(vA, valA) : _mm256_cmpgt_epi32(valA, vA);
+            __m256i maskB = IsMax ? _mm256_cmpgt_epi32(vB, valB) : _mm256_cmpgt_epi32(valB, vB);
+            valA = _mm256_blendv_epi8(valA, vA, maskA);
+            valB = _mm256_blendv_epi8(valB, vB, maskB);
+            idxA = _mm256_blendv_epi8(idxA, curA, maskA);
+            idxB = _mm256_blendv_epi8(idxB, curB, maskB);
+        }
+
+        union { __m256i v; int32_t x[8]; } va, vb, ia, ib;
+        va.v = valA; vb.v = valB; ia.v = idxA; ib.v = idxB;
+        for (int lane = 0; lane < 8; ++lane) {
+            considerCandidate<IsMax>(best, va.x[lane], ia.x[lane]);
+            considerCandidate<IsMax>(best, vb.x[lane], ib.x[lane]);
+        }
+    }
+    for (; i < n; ++i) {
+        considerCandidate<IsMax>(best, data[i], static_cast<long>(i));
+    }
+    return best;
+}
+
+ArgResult<float> simdArgMin(const float* data, size_t n, NanPolicy policy = IGNORE_NAN) { return simdArgExtreme<false>(data, n, policy); }
+ArgResult<float> simdArgMax(const float* data, size_t n, NanPolicy policy = IGNORE_NAN) { return simdArgExtreme<true>(data, n, policy); }
+ArgResult<int32_t> simdArgMin(const int32_t* data, size_t n) { return simdArgExtreme<false>(data, n); }
+ArgResult<int32_t> simdArgMax(const int32_t* data, size_t n) { return simdArgExtreme<true>(data, n); }
+
+//--------- min / max (value only) -------------//
+
+/*
+ * _mm256_min_ps(v, best) returns best whenever v is NaN, so starting from +/-infinity skips NaNs
+ * for free. PROPAGATE_NAN additionally ORs together an "is NaN" mask.
+ * Returns +infinity (min) / -infinity (max) for an empty input or one with only NaNs.
+ */
+template<bool IsMax>
+float simdExtreme(const float* data, size_t n, NanPolicy policy) {
+    const float start = IsMax ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::infinity();
+    __m256 acc[4];
+    for (int a = 0; a < 4; ++a) acc[a] = _mm256_set1_ps(start);
+    __m256 nanSeen = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        for (int a = 0; a < 4; ++a) {
+            __m256 v = _mm256_loadu_ps(data + i + 8 * a);
+            acc[a] = IsMax ? _mm256_max_ps(v, acc[a]) : _mm256_min_ps(v, acc[a]);
+            if (policy == PROPAGATE_NAN) nanSeen = _mm256_or_ps(nanSeen, _mm256_cmp_ps(v, v, _CMP_UNORD_Q));
+        }
+    }
+    __m256 total = IsMax ? _mm256_max_ps(_mm256_max_ps(acc[0], acc[1]), _mm256_max_ps(acc[2], acc[3]))
+                         : _mm256_min_ps(_mm256_min_ps(acc[0], acc[1]), _mm256_min_ps(acc[2], acc[3]));
+    union { __m256 v; float f[8]; } lanes;
+    lanes.v = total;
+    float result = start;
+    bool anyNan = _mm256_movemask_ps(nanSeen) != 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        result = IsMax ? std::max(result, lanes.f[lane]) : std::min(result, lanes.f[lane]);
+    }
+    for (; i < n; ++i) {
+        if (std::isnan(data[i])) {
+            anyNan = anyNan || policy == PROPAGATE_NAN;
+        } else {
+            result = IsMax ? std::max(result, data[i]) : std::min(result, data[i]);
+        }
+    }
+    return anyNan ? std::numeric_limits<float>::quiet_NaN() : result;
+}
+
+// Returns INT32_MAX (min) / INT32_MIN (max) for an empty input
+template<bool IsMax>
+int32_t simdExtreme(const int32_t* data, size_t n) {
+    const int32_t start = IsMax ? std::numeric_limits<int32_t>::min() : std::numeric_limits<int32_t>::max();
+    __m256i acc[4];
+    for (int a = 0; a < 4; ++a) acc[a] = _mm256_set1_epi32(start);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        for (int a = 0; a < 4; ++a) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(data + i + 8 * a));
+            acc[a] = IsMax ? _mm256_max_epi32(v, acc[a]) : _mm256_min_epi32(v, acc[a]);
+        }
+    }
+    __m256i total = IsMax ? _mm256_max_epi32(_mm256_max_epi32(acc[0], acc[1]), _mm256_max_epi32(acc[2], acc[3]))
+                          : _mm256_min_epi32(_mm256_min_epi32(acc[0], acc[1]), _mm256_min_epi32(acc[2], acc[3]));
+    union { __m256i v; int32_t x[8]; } lanes;
+    lanes.v = total;
+    int32_t result = start;
+    for (int lane = 0; lane < 8; ++lane) {
+        result = IsMax ? std::max(result, lanes.x[lane]) : std::min(result, lanes.x[lane]);
+    }
+    for (; i < n; ++i) {
+        result = IsMax ? std::max(result, data[i]) : std::min(result, data[i]);
+    }
+    return result;
+}
+
+float simdMin(const float* data, size_t n, NanPolicy policy = IGNORE_NAN) { return simdExtreme<false>(data, n, policy); }
+float simdMax(const float* data, size_t n, NanPolicy policy = IGNORE_NAN) { return simdExtreme<true>(data, n, policy); }
+int32_t simdMin(const int32_t* data, size_t n) { return simdExtreme<false>(data, n); }
+int32_t simdMax(const int32_t* data, size_t n) { return simdExtreme<true>(data, n); }
+
+//--------- Benchmark -------------//
+
+// Calls f `repeats` times and returns the average time in ms
+template<typename Func>
+double measurePerformance(Func f, int repeats) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        f();
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / repeats;
+}
+
+void report(const char* name, double ms, size_t bytes) {
+    std::cout << name << " took " << ms << " ms (" << bytes / ms / 1e6 << " GB/s)" << std::endl;
+}
+
+template<typename T>
+bool benchmark(const char* label, const std::vector<T>& data, int repeats) {
+    size_t n = data.size();
+    size_t bytes = n * sizeof(T);
+    volatile long sink = 0;
+    std::cout << "----------- " << label << " ------------" << std::endl;
+
+    long stdMin = 0, stdMax = 0;
+    ArgResult<T> argMin = { 0, -1 }, argMax = { 0, -1 };
+    T minValue = 0, maxValue = 0;
+
+    report("std::min_element", measurePerformance([&] {
+        stdMin = std::min_element(data.begin(), data.end()) - data.begin(); sink = stdMin; }, repeats), bytes);
+    report("SIMD argmin     ", measurePerformance([&] {
+        argMin = simdArgMin(data.data(), n); sink = argMin.index; }, repeats), bytes);
+    report("SIMD min        ", measurePerformance([&] {
+        minValue = simdMin(data.data(), n); sink = static_cast<long>(minValue); }, repeats), bytes);
+    report("std::max_element", measurePerformance([&] {
+        stdMax = std::max_element(data.begin(), data.end()) - data.begin(); sink = stdMax; }, repeats), bytes);
+    report("SIMD argmax     ", measurePerformance([&] {
+        argMax = simdArgMax(data.data(), n); sink = argMax.index; }, repeats), bytes);
+    report("SIMD max        ", measurePerformance([&] {
+        maxValue = simdMax(data.data(), n); sink = static_cast<long>(maxValue); }, repeats), bytes);
+
+    bool ok = argMin.index == stdMin && argMax.index == stdMax &&
+              minValue == data[stdMin] && maxValue == data[stdMax];
+    std::cout << "argmin " << argMin.index << ", argmax " << argMax.index
+              << (ok ? " (matches std)" : " (MISMATCH)") << std::endl;
+    return ok;
+}
+
+// Small fixed inputs that pin down the tie-break and NaN rules
+bool checkSemantics() {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::vector<float> data(40, 3.0f);
+    data[5] = 1.0f;   // first minimum
+    data[29] = 1.0f;  // tie, later index
+    data[12] = 9.0f;  // first maximum
+    data[33] = 9.0f;
+    data[20] = nan;   // first NaN
+    data[37] = nan;
+
+    ArgResult<float> ignoreMin = simdArgMin(data.data(), data.size(), IGNORE_NAN);
+    ArgResult<float> ignoreMax = simdArgMax(data.data(), data.size(), IGNORE_NAN);
+    ArgResult<float> propagateMin = simdArgMin(data.data(), data.size(), PROPAGATE_NAN);
+    std::vector<float> allNan(20, nan);
+    ArgResult<float> noResult = simdArgMin(allNan.data(), allNan.size(), IGNORE_NAN);
+
+    std::cout << "----------- tie-break and NaN handling ------------" << std::endl;
+    std::cout << "argmin (ignore NaN): " << ignoreMin.index << ", argmax (ignore NaN): " << ignoreMax.index
+              << ", argmin (propagate NaN): " << propagateMin.index << ", all-NaN argmin: " << noResult.index
+              << std::endl;
+    std::cout << "min (ignore NaN): " << simdMin(data.data(), data.size(), IGNORE_NAN)
+              << ", min (propagate NaN): " << simdMin(data.data(), data.size(), PROPAGATE_NAN) << std::endl;
+
+    return ignoreMin.index == 5 && ignoreMax.index == 12 && propagateMin.index == 20 && noResult.index == -1 &&
+           simdMin(data.data(), data.size(), IGNORE_NAN) == 1.0f &&
+           std::isnan(simdMin(data.data(), data.size(), PROPAGATE_NAN));
+}
+
+int main() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> realDist(-1000.0f, 1000.0f);
+    std::uniform_int_distribution<int32_t> intDist(-1000000, 1000000);
+
+    const size_t l1Size = 4096;       // 16 KB, fits in L1
+    const size_t dramSize = 1 << 25;  // 128 MB, spills to DRAM
+
+    bool ok = checkSemantics();
+
+    std::vector<float> floats(dramSize);
+    std::vector<int32_t> ints(dramSize);
+    for (size_t i = 0; i < dramSize; ++i) {
+        floats[i] = realDist(rng);
+        ints[i] = intDist(rng);
+    }
+    std::vector<float> floatsL1(floats.begin(), floats.begin() + l1Size);
+    std::vector<int32_t> intsL1(ints.begin(), ints.begin() + l1Size);
+
+    ok = benchmark("float, L1 (4096 elements)", floatsL1, 100000) && ok;
+    ok = benchmark("float, DRAM (32M elements)", floats, 10) && ok;
+    ok = benchmark("int32, L1 (4096 elements)", intsL1, 100000) && ok;
+    ok = benchmark("int32, DRAM (32M elements)", ints, 10) && ok;
+
+    if (!ok) {
+        std::cerr << "SIMD reduction produced a wrong result." << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,309 @@
+#include "immintrin.h" // AVX2 + FMA, 256 bit operations
+#include <unistd.h>     // sysconf, for cache sizes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. All Pairs: where 02_dot_product compares vectors1[i] with vectors2[i], this chapter scores
+ *    every query point against every target point (an M x N matrix of squared distances or dots).
+ * 2. Register Blocking: targets are stored as structure-of-arrays, so 8 targets fill one
+ *    register per coordinate. A 4 x 16 block loads 16 targets once and reuses them for 4
+ *    broadcasted query points (_mm256_set1_ps).
+ * 3. Cache Tiling: the target columns and the query rows of a tile both stay in L1, where they
+ *    are re-read. The output is never re-read, so it is written with non-temporal stores
+ *    (_mm256_stream_ps) that go to memory without passing through, and evicting, L1. Tile sizes
+ *    come from the L1 size reported by the OS.
+ * 4. Threshold Mode: instead of writing the matrix, emits only the (i, j) pairs closer than a
+ *    threshold (a mask + _mm256_movemask_ps per register), for point sets too large to store.
+ *
+ * Focus:
+ * - Reports GFLOP/s for the scalar and SIMD kernels (8 flops per squared distance, 5 per dot).
+ */
+
+// 3D vector structure
+struct Vec3 {
+    float x, y, z;
+    Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+enum Measure { SQUARED_DISTANCE, DOT };
+
+//--------- Layout -------------//
+
+/*
+ * Structure-of-arrays copy of a point set. Rows are padded to `multiple` with NaN points: NaN
+ * never passes a threshold test, and padded entries of a matrix are simply never read.
+ */
+struct PointsSoA {
+    size_t count;
+    size_t padded;
+    std::vector<float> x, y, z;
+
+    PointsSoA(const std::vector<Vec3>& points, size_t multiple)
+        : count(points.size()), padded((points.size() + multiple - 1) / multiple * multiple),
+          x(padded, NAN), y(padded, NAN), z(padded, NAN) {
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = points[i].x;
+            y[i] = points[i].y;
+            z[i] = points[i].z;
+        }
+    }
+};
+
+// Row-major M x N result; ld is the padded row length. The storage is 64-byte aligned, so with ld
+// a multiple of 16 every 4 x 16 block row is one whole cache line, as the streaming stores need.
+struct Matrix {
+    size_t rows, cols, ld;
+    std::unique_ptr<float, void (*)(void*)> storage;
+    float* data;
+
+    Matrix(size_t rows, size_t cols, size_t paddedRows, size_t ld)
+        : rows(rows), cols(cols), ld(ld),
+          storage(static_cast<float*>(aligned_alloc(64, (paddedRows * ld * sizeof(float) + 63) / 64 * 64)), free),
+          data(storage.get()) {
+        std::fill(data, data + paddedRows * ld, 0.0f);
+    }
+    float at(size_t i, size_t j) const { return data[i * ld + j]; }
+};
+
+struct Pair {
+    unsigned i, j;
+    float value;
+};
+
+struct TileSizes {
+    size_t rows;
+    size_t cols;
+};
+
+/*
+ * Both tiles are sized for what is re-read. The target tile (x, y, z columns) is reused by every
+ * query row of the row tile, and the query rows are reused against every target tile, so both
+ * stay in L1: half of it for the targets, a quarter for the queries, the rest for the stack and
+ * the loop's other lines. The output takes no L1 space: MatrixSink writes it with non-temporal
+ * stores, so a 4-row pass over a 2048-column tile (32 KB of output) does not evict the target
+ * tile. A taller row tile also spreads the reload of each target tile (12 bytes per target) over
+ * more rows, until it is small next to the 4 output bytes stored per pair.
+ * Falls back to a 32 KB L1 when the OS does not report cache sizes.
+ */
+TileSizes tileSizesFromCache() {
+    long l1 = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (l1 <= 0) l1 = 32 * 1024;
+    TileSizes t;
+    t.cols = std::max<size_t>(16, static_cast<size_t>(l1) / 2 / (3 * sizeof(float)) / 16 * 16);
+    t.rows = std::max<size_t>(4, static_cast<size_t>(l1) / 4 / (3 * sizeof(float)) / 4 * 4);
+    return t;
+}
+
+//--------- Scalar reference -------------//
+
+inline float measure(const Vec3& a, const Vec3& b, Measure m) {
+    if (m == DOT) return a.x * b.x + a.y * b.y + a.z * b.z;
+    float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void scalarMatrix(const std::vector<Vec3>& queries, const std::vector<Vec3>& targets, Measure m, Matrix& out) {
+    for (size_t i = 0; i < queries.size(); ++i) {
+        for (size_t j = 0; j < targets.size(); ++j) {
+            out.data[i * out.ld + j] = measure(queries[i], targets[j], m);
+        }
+    }
+}
+
+//--------- SIMD kernel -------------//
+
+/*
+ * Computes the 4 x 16 block of rows i..i+3 and columns j..j+15 and hands each row's two result
+ * registers to sink(row, column, lo, hi).
+ */
+template<Measure M, typename Sink>
+inline void block4x16(const PointsSoA& q, const PointsSoA& t, size_t i, size_t j, Sink& sink) {
+    __m256 tx0 = _mm256_loadu_ps(&t.x[j]), tx1 = _mm256_loadu_ps(&t.x[j + 8]);
+    __m256 ty0 = _mm256_loadu_ps(&t.y[j]), ty1 = _mm256_loadu_ps(&t.y[j + 8]);
+    __m256 tz0 = _mm256_loadu_ps(&t.z[j]), tz1 = _mm256_loadu_ps(&t.z[j + 8]);
+    for (size_t r = i; r < i + 4; ++r) {
+        __m256 qx = _mm256_set1_ps(q.x[r]);
+        __m256 qy = _mm256_set1_ps(q.y[r]);
+        __m256 qz = _mm256_set1_ps(q.z[r]);
+        __m256 lo, hi;
+        if (M == DOT) {
+            lo = _mm256_fmadd_ps(qz, tz0, _mm256_fmadd_ps(qy, ty0, _mm256_mul_ps(qx, tx0)));
+            hi = _mm256_fmadd_ps(qz, tz1, _mm256_fmadd_ps(qy, ty1, _mm256_mul_ps(qx, tx1)));
+        } else {
+            __m256 dx0 = _mm256_sub_ps(qx, tx0), dx1 = _mm256_sub_ps(qx, tx1);
+            __m256 dy0 = _mm256_sub_ps(qy, ty0), dy1 = _mm256_sub_ps(qy, ty1);
+            __m256 dz0 = _mm256_sub_ps(qz, tz0), dz1 = _mm256_sub_ps(qz, tz1);
+            lo = _mm256_fmadd_ps(dz0, dz0, _mm256_fmadd_ps(dy0, dy0, _mm256_mul_ps(dx0, dx0)));
+            hi = _mm256_fmadd_ps(dz1, dz1, _mm256_fmadd_ps(dy1, dy1, _mm256_mul_ps(dx1, dx1)));
+        }
+        sink(r, j, lo, hi);
+    }
+}
+
+// Walks the padded index space tile by tile
+template<Measure M, typename Sink>
+void tiledLoop(const PointsSoA& q, const PointsSoA& t, TileSizes tiles, Sink& sink) {
+    for (size_t rowTile = 0; rowTile < q.padded; rowTile += tiles.rows) {
+        size_t rowEnd = std::min(q.padded, rowTile + tiles.rows);
+        for (size_t colTile = 0; colTile < t.padded; colTile += tiles.cols) {
+            size_t colEnd = std::min(t.padded, colTile + tiles.cols);
+            for (size_t i = rowTile; i < rowEnd; i += 4) {
+                for (size_t j = colTile; j < colEnd; j += 16) {
+                    block4x16<M>(q, t, i, j, sink);
+                }
+            }
+        }
+    }
+}
+
+// Non-temporal stores: lo and hi fill one aligned cache line, which goes to memory through a
+// write-combining buffer instead of being read into L1 first
+struct MatrixSink {
+    Matrix& out;
+    void operator()(size_t r, size_t j, __m256 lo, __m256 hi) {
+        _mm256_stream_ps(&out.data[r * out.ld + j], lo);
+        _mm256_stream_ps(&out.data[r * out.ld + j + 8], hi);
+    }
+};
+
+// Keeps squared distances below the threshold, or dot products above it
+template<Measure M>
+struct ThresholdSink {
+    __m256 threshold;
+    std::vector<Pair>& pairs;
+
+    void emit(size_t r, size_t j, __m256 v) {
+        __m256 pass = M == DOT ? _mm256_cmp_ps(v, threshold, _CMP_GT_OQ) : _mm256_cmp_ps(v, threshold, _CMP_LT_OQ);
+        int mask = _mm256_movemask_ps(pass);
+        if (mask == 0) return;
+        union { __m256 v; float f[8]; } values;
+        values.v = v;
+        while (mask) {
+            int lane = __builtin_ctz(mask);
+            Pair p = { static_cast<unsigned>(r), static_cast<unsigned>(j + lane), values.f[lane] };
+            pairs.push_back(p);
+            mask &= mask - 1;
+        }
+    }
+    void operator()(size_t r, size_t j, __m256 lo, __m256 hi) {
+        emit(r, j, lo);
+        emit(r, j + 8, hi);
+    }
+};
+
+// Output with padded rows and columns, as expected by simdMatrix
+Matrix makeSimdMatrix(size_t rows, size_t cols) {
+    return Matrix(rows, cols, (rows + 3) / 4 * 4, (cols + 15) / 16 * 16);
+}
+
+template<Measure M>
+void simdMatrix(const std::vector<Vec3>& queries, const std::vector<Vec3>& targets, TileSizes tiles, Matrix& out) {
+    PointsSoA q(queries, 4), t(targets, 16);
+    MatrixSink sink = { out };
+    tiledLoop<M>(q, t, tiles, sink);
+    _mm_sfence(); // streaming stores are weakly ordered; make them visible before out is read
+}
+
+// Pairs are grouped by tile, not sorted
+template<Measure M>
+std::vector<Pair> simdThresholdPairs(const std::vector<Vec3>& queries, const std::vector<Vec3>& targets,
+                                     float threshold, TileSizes tiles) {
+    PointsSoA q(queries, 4), t(targets, 16);
+    std::vector<Pair> pairs;
+    ThresholdSink<M> sink = { _mm256_set1_ps(threshold), pairs };
+    tiledLoop<M>(q, t, tiles, sink);
+    return pairs;
+}
+
+//--------- Benchmark -------------//
+
+std::vector<Vec3> randomPoints(size_t n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::vector<Vec3> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i) points.push_back(Vec3(coord(rng), coord(rng), coord(rng)));
+    return points;
+}
+
+double elapsedSeconds(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+void report(const char* name, double seconds, double pairs, int flopsPerPair) {
+    std::cout << name << " took " << seconds * 1000 << " ms (" << pairs * flopsPerPair / seconds / 1e9 << " GFLOP/s)" << std::endl;
+}
+
+template<Measure M>
+bool benchmarkMatrix(const char* label, const std::vector<Vec3>& queries, const std::vector<Vec3>& targets, TileSizes tiles) {
+    const int flops = M == DOT ? 5 : 8;
+    double pairs = static_cast<double>(queries.size()) * targets.size();
+    std::cout << "----------- " << label << ": " << queries.size() << " x " << targets.size() << " matrix ------" << std::endl;
+
+    Matrix expected(queries.size(), targets.size(), queries.size(), targets.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    scalarMatrix(queries, targets, M, expected);
+    report("scalar", elapsedSeconds(start), pairs, flops);
+
+    Matrix result = makeSimdMatrix(queries.size(), targets.size());
+    start = std::chrono::high_resolution_clock::now();
+    simdMatrix<M>(queries, targets, tiles, result);
+    report("SIMD  ", elapsedSeconds(start), pairs, flops);
+
+    // FMA rounds once where the scalar code rounds twice, so compare with a relative tolerance
+    for (size_t i = 0; i < queries.size(); ++i) {
+        for (size_t j = 0; j < targets.size(); ++j) {
+            float e = expected.at(i, j);
+            if (std::fabs(result.at(i, j) - e) > 1e-3f * std::max(1.0f, std::fabs(e))) return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    std::mt19937 rng(5);
+    TileSizes tiles = tileSizesFromCache();
+    std::cout << "Tile: " << tiles.rows << " query rows x " << tiles.cols << " target columns" << std::endl;
+
+    // Sizes deliberately not multiples of the block, to exercise the padding
+    std::vector<Vec3> queries = randomPoints(4093, rng);
+    std::vector<Vec3> targets = randomPoints(4099, rng);
+    bool ok = true;
+    ok = benchmarkMatrix<SQUARED_DISTANCE>("squared distance", queries, targets, tiles) && ok;
+    ok = benchmarkMatrix<DOT>("dot", queries, targets, tiles) && ok;
+
+    //-------- threshold mode on large sets ---------------//
+    const float threshold = 4.0f * 4.0f; // squared radius
+    std::cout << "----------- pairs closer than 4.0 ------------------------------------" << std::endl;
+    size_t expectedCount = 0;
+    for (const Vec3& a : queries) {
+        for (const Vec3& b : targets) {
+            if (measure(a, b, SQUARED_DISTANCE) < threshold) ++expectedCount;
+        }
+    }
+    std::vector<Pair> small = simdThresholdPairs<SQUARED_DISTANCE>(queries, targets, threshold, tiles);
+    ok = ok && small.size() == expectedCount;
+    std::cout << queries.size() << " x " << targets.size() << ": " << small.size() << " pairs (scalar count "
+              << expectedCount << ")" << std::endl;
+
+    std::vector<Vec3> bigQueries = randomPoints(50000, rng);
+    std::vector<Vec3> bigTargets = randomPoints(50000, rng);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Pair> close = simdThresholdPairs<SQUARED_DISTANCE>(bigQueries, bigTargets, threshold, tiles);
+    double seconds = elapsedSeconds(start);
+    std::cout << bigQueries.size() << " x " << bigTargets.size() << ": " << close.size() << " pairs" << std::endl;
+    report("SIMD threshold", seconds, static_cast<double>(bigQueries.size()) * bigTargets.size(), 8);
+
+    if (!ok) {
+        std::cerr << "SIMD distance matrix produced a wrong result." << std::endl;
+        return 1;
+    }
+    return 0;
+}
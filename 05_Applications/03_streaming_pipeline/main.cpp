@@ -0,0 +1,435 @@
+#include "immintrin.h" // AVX2 + FMA, 256 bit operations
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/*
+ * Key Components:
+ * 1. Ring Buffer: a bounded, lock-free single-producer / multi-consumer queue of 32-byte aligned
+ *    blocks. Each slot carries a sequence number; the producer waits for a slot to come back
+ *    (backpressure), consumers claim filled slots with a compare-and-swap and work on them in place.
+ * 2. Batching: records are packed structure-of-arrays into blocks of BLOCK_RECORDS, so workers
+ *    run the SIMD kernels over whole blocks with aligned loads. Input is read with read(2), which
+ *    returns whatever has arrived, and a block is published early once the input has stalled past
+ *    the flush deadline (--flush-ms after its first record), so a slow producer is not held to EOF.
+ * 3. Kernels: the quadratic root of 02_quadratic_equations and the Vec3 dot product of
+ *    02_dot_product, applied to a continuous stream instead of a fixed batch.
+ * 4. Metrics: sustained records/s, producer stalls, and per-block latency percentiles (from
+ *    the moment the block's first record arrives to the moment a worker has finished it, so the
+ *    wait for the block to fill is included).
+ *
+ * Usage:
+ *   simd_program <quadratic|dot> [file|-] [--workers N] [--flush-ms N]
+ *                                                         stream text records from a file or stdin
+ *   simd_program <quadratic|dot> --generate N [...]      stream N random records without parsing
+ *   simd_program --emit <quadratic|dot> N                write N random text records to stdout
+ *
+ *   e.g. ./simd_program --emit quadratic 1000000 | ./simd_program quadratic -
+ *
+ * A quadratic record is "a b c"; a dot record is "x1 y1 z1 x2 y2 z2".
+ */
+
+const int BLOCK_RECORDS = 1024; // multiple of 8
+const int MAX_FIELDS = 6;
+const size_t RING_SLOTS = 64;   // power of 2
+
+typedef std::chrono::steady_clock Clock;
+
+enum Kernel { QUADRATIC, DOT };
+
+int fieldCount(Kernel kernel) { return kernel == QUADRATIC ? 3 : 6; }
+
+struct alignas(32) Block {
+    float fields[MAX_FIELDS][BLOCK_RECORDS]; // field-major, so each field is a contiguous array
+    float results[BLOCK_RECORDS];
+    int count;
+    // Clock ticks when the first record was read; a raw count keeps Block trivial, since the ring
+    // never constructs its slots
+    int64_t firstRecordTicks;
+};
+
+//--------- Lock-free SPMC ring -------------//
+
+class BlockRing {
+public:
+    BlockRing() : blocks((Block*)aligned_alloc(32, RING_SLOTS * sizeof(Block))), head(0), tail(0),
+                  closed(false), stalls(0) {
+        for (size_t i = 0; i < RING_SLOTS; ++i) sequence[i].store(i, std::memory_order_relaxed);
+    }
+    ~BlockRing() { free(blocks); }
+
+    bool valid() const { return blocks != nullptr; }
+
+    // Producer: waits until the next slot has been released by the workers, then hands it out
+    Block* acquireEmpty() {
+        size_t slot = head & (RING_SLOTS - 1);
+        if (sequence[slot].load(std::memory_order_acquire) != head) {
+            stalls.fetch_add(1, std::memory_order_relaxed);
+            while (sequence[slot].load(std::memory_order_acquire) != head) std::this_thread::yield();
+        }
+        return &blocks[slot];
+    }
+
+    // Producer: makes the block returned by acquireEmpty visible to workers
+    void publish() {
+        size_t slot = head & (RING_SLOTS - 1);
+        sequence[slot].store(head + 1, std::memory_order_release);
+        ++head;
+    }
+
+    void close() { closed.store(true, std::memory_order_release); }
+
+    /*
+     * Consumer: claims the next filled block, or returns null once the ring is closed and drained.
+     * *ticket must be passed back to release().
+     */
+    Block* claim(size_t* ticket) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t slot = pos & (RING_SLOTS - 1);
+            size_t seq = sequence[slot].load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *ticket = pos;
+                    return &blocks[slot];
+                }
+                // pos was reloaded by the failed CAS
+            } else if (seq <= pos) {
+                // Empty: read closed first, then recheck, so a block published before close() is not missed
+                if (closed.load(std::memory_order_acquire) && sequence[slot].load(std::memory_order_acquire) <= pos) {
+                    return nullptr;
+                }
+                std::this_thread::yield();
+                pos = tail.load(std::memory_order_relaxed);
+            } else {
+                pos = tail.load(std::memory_order_relaxed); // another worker claimed it
+            }
+        }
+    }
+
+    // Consumer: hands the slot back to the producer for the next lap
+    void release(size_t ticket) {
+        sequence[ticket & (RING_SLOTS - 1)].store(ticket + RING_SLOTS, std::memory_order_release);
+    }
+
+    size_t stallCount() const { return stalls.load(); }
+
+private:
+    Block* blocks;
+    std::atomic<size_t> sequence[RING_SLOTS];
+    size_t head; // producer only
+    alignas(64) std::atomic<size_t> tail;
+    alignas(64) std::atomic<bool> closed;
+    std::atomic<size_t> stalls;
+};
+
+//--------- SIMD kernels over one block -------------//
+
+// Smaller root of a*x^2 + b*x + c, or 9999 when there is no real solution
+void quadraticBlock(Block& block) {
+    const float* a = block.fields[0];
+    const float* b = block.fields[1];
+    const float* c = block.fields[2];
+    for (int i = 0; i < block.count; i += 8) {
+        __m256 aCoeffs = _mm256_load_ps(a + i);
+        __m256 bCoeffs = _mm256_load_ps(b + i);
+        __m256 cCoeffs = _mm256_load_ps(c + i);
+        __m256 disc = _mm256_fmsub_ps(bCoeffs, bCoeffs, _mm256_mul_ps(_mm256_set1_ps(4), _mm256_mul_ps(aCoeffs, cCoeffs)));
+        __m256 mask = _mm256_cmp_ps(disc, _mm256_setzero_ps(), _CMP_GT_OQ);
+        __m256 root = _mm256_div_ps(
+            _mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), bCoeffs), _mm256_sqrt_ps(disc)),
+            _mm256_mul_ps(_mm256_set1_ps(2), aCoeffs));
+        _mm256_store_ps(block.results + i, _mm256_blendv_ps(_mm256_set1_ps(9999), root, mask));
+    }
+}
+
+void dotBlock(Block& block) {
+    for (int i = 0; i < block.count; i += 8) {
+        __m256 x1 = _mm256_load_ps(block.fields[0] + i), y1 = _mm256_load_ps(block.fields[1] + i);
+        __m256 z1 = _mm256_load_ps(block.fields[2] + i), x2 = _mm256_load_ps(block.fields[3] + i);
+        __m256 y2 = _mm256_load_ps(block.fields[4] + i), z2 = _mm256_load_ps(block.fields[5] + i);
+        _mm256_store_ps(block.results + i, _mm256_fmadd_ps(x1, x2, _mm256_fmadd_ps(y1, y2, _mm256_mul_ps(z1, z2))));
+    }
+}
+
+//--------- Record sources -------------//
+
+enum ReadStatus { READ_VALUE, READ_STALLED, READ_END };
+
+/*
+ * Buffered whitespace-separated float reader over a file descriptor. read(2) returns as soon as
+ * any input is available, so records from a slow producer are parsed when they arrive instead of
+ * once a whole buffer has filled.
+ */
+class FloatReader {
+public:
+    explicit FloatReader(int fd) : fd(fd), buffer(1 << 20), begin(0), end(0), complete(0), eof(false) { buffer[0] = '\0'; }
+
+    /*
+     * Parses the next number. If more input is needed and none arrives before `deadline`, returns
+     * READ_STALLED and keeps any partial number buffered; Clock::time_point::max() waits for input.
+     */
+    ReadStatus next(float& value, Clock::time_point deadline) {
+        for (;;) {
+            while (begin < end && isSpace(buffer[begin])) ++begin;
+            // Only parse a number whose terminating whitespace has arrived, or the last one at EOF
+            if (begin >= complete && !eof) {
+                if (!refill(deadline)) return READ_STALLED;
+                continue;
+            }
+            if (begin >= end) return READ_END;
+            char* parsed;
+            value = std::strtof(&buffer[begin], &parsed);
+            if (parsed == &buffer[begin]) return READ_END; // not a number
+            begin = parsed - &buffer[0];
+            return READ_VALUE;
+        }
+    }
+
+private:
+    int fd;
+    std::vector<char> buffer;
+    size_t begin, end;
+    size_t complete; // one past the last whitespace: every number starting before it is whole
+    bool eof;
+
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\t' || c == '\r'; }
+
+    // Appends whatever input is available, waiting at most until deadline; false if none arrived
+    bool refill(Clock::time_point deadline) {
+        std::memmove(&buffer[0], &buffer[begin], end - begin);
+        end -= begin;
+        begin = 0;
+        complete = 0;
+        if (deadline != Clock::time_point::max()) {
+            long long leftUs = std::chrono::duration_cast<std::chrono::microseconds>(deadline - Clock::now()).count();
+            if (leftUs <= 0) return false;
+            pollfd ready = { fd, POLLIN, 0 };
+            int polled;
+            while ((polled = poll(&ready, 1, static_cast<int>((leftUs + 999) / 1000))) < 0 && errno == EINTR) {}
+            if (polled == 0) return false;
+        }
+        ssize_t got;
+        while ((got = read(fd, &buffer[end], buffer.size() - end - 1)) < 0 && errno == EINTR) {}
+        if (got < 0) std::cerr << "Read failed: " << std::strerror(errno) << std::endl;
+        if (got <= 0) eof = true;
+        else end += got;
+        buffer[end] = '\0';
+        for (complete = end; complete > 0 && !isSpace(buffer[complete - 1]); --complete) {}
+        return true;
+    }
+};
+
+// Random coefficients / vectors with the same ranges as the examples in 02 and 03
+void randomRecord(Kernel kernel, std::mt19937& rng, float* out) {
+    std::uniform_real_distribution<float> coeff(-10.0f, 10.0f), unit(-1.0f, 1.0f);
+    for (int f = 0; f < fieldCount(kernel); ++f) out[f] = kernel == QUADRATIC ? coeff(rng) : unit(rng);
+    if (kernel == QUADRATIC && out[0] == 0.0f) out[0] = 1.0f;
+}
+
+// Pads a partial block with records that produce harmless results (a=1, b=0, c=1 has no real root)
+void padBlock(Block& block, Kernel kernel) {
+    int padded = (block.count + 7) / 8 * 8;
+    for (int i = block.count; i < padded; ++i) {
+        for (int f = 0; f < MAX_FIELDS; ++f) block.fields[f][i] = kernel == QUADRATIC && f != 1 ? 1.0f : 0.0f;
+    }
+}
+
+//--------- Pipeline -------------//
+
+// One cache line per worker: every worker updates its stats after every block
+struct alignas(64) WorkerStats {
+    size_t records = 0;
+    double checksum = 0;
+    std::vector<double> latenciesUs;
+};
+
+void worker(BlockRing& ring, Kernel kernel, WorkerStats& stats) {
+    size_t ticket;
+    while (Block* block = ring.claim(&ticket)) {
+        if (kernel == QUADRATIC) quadraticBlock(*block);
+        else dotBlock(*block);
+        double sum = 0;
+        for (int i = 0; i < block->count; ++i) sum += block->results[i];
+        stats.checksum += sum;
+        stats.records += block->count;
+        Clock::duration waited(Clock::now().time_since_epoch().count() - block->firstRecordTicks);
+        stats.latenciesUs.push_back(std::chrono::duration<double, std::micro>(waited).count());
+        ring.release(ticket);
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+enum FillStatus { FILL_RECORD, FILL_STALLED, FILL_END };
+
+/*
+ * Runs the producer on the calling thread. `fill(float* record, Clock::time_point deadline)` writes
+ * one record's fields, returns FILL_STALLED if no whole record arrived before the deadline, or
+ * FILL_END at the end of the stream. A block is published when it is full, when the input stalls
+ * past `flush` after the block's first record, or at the end of the stream.
+ */
+template<typename Fill>
+int runPipeline(Kernel kernel, int workers, std::chrono::milliseconds flush, Fill fill) {
+    BlockRing ring;
+    if (!ring.valid()) {
+        std::cerr << "Memory allocation failed." << std::endl;
+        return 1;
+    }
+    std::vector<WorkerStats> stats(workers);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int w = 0; w < workers; ++w) threads.push_back(std::thread(worker, std::ref(ring), kernel, std::ref(stats[w])));
+
+    const int fields = fieldCount(kernel);
+    float record[MAX_FIELDS];
+    bool more = true;
+    size_t blocks = 0, flushed = 0;
+    while (more) {
+        Block* block = ring.acquireEmpty();
+        block->count = 0;
+        // No deadline until the block holds a record: an empty block is never worth publishing
+        Clock::time_point deadline = Clock::time_point::max();
+        while (block->count < BLOCK_RECORDS) {
+            FillStatus status = fill(record, deadline);
+            if (status == FILL_END) {
+                more = false;
+                break;
+            }
+            if (status == FILL_STALLED) {
+                ++flushed;
+                break;
+            }
+            if (block->count == 0) {
+                Clock::time_point now = Clock::now();
+                block->firstRecordTicks = now.time_since_epoch().count();
+                deadline = now + flush;
+            }
+            for (int f = 0; f < fields; ++f) block->fields[f][block->count] = record[f];
+            ++block->count;
+        }
+        if (block->count == 0) break;
+        padBlock(*block, kernel);
+        ring.publish();
+        ++blocks;
+    }
+    ring.close();
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    size_t records = 0;
+    double checksum = 0;
+    std::vector<double> latencies;
+    for (const WorkerStats& s : stats) {
+        records += s.records;
+        checksum += s.checksum;
+        latencies.insert(latencies.end(), s.latenciesUs.begin(), s.latenciesUs.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "----------- " << (kernel == QUADRATIC ? "quadratic" : "dot product") << " stream, "
+              << workers << " worker(s) -----------" << std::endl;
+    std::cout << "records: " << records << " in " << blocks << " blocks (" << flushed << " flushed before full), "
+              << seconds * 1000 << " ms" << std::endl;
+    std::cout << "throughput: " << records / seconds / 1e6 << " M records/s" << std::endl;
+    std::cout << "producer stalls (ring full): " << ring.stallCount() << std::endl;
+    std::cout << "block latency (us): p50 " << percentile(latencies, 0.50) << ", p90 " << percentile(latencies, 0.90)
+              << ", p99 " << percentile(latencies, 0.99) << ", max " << (latencies.empty() ? 0 : latencies.back()) << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+    return 0;
+}
+
+int usage() {
+    std::cerr << "usage: simd_program <quadratic|dot> [file|-|--generate N] [--workers N] [--flush-ms N]" << std::endl
+              << "       simd_program --emit <quadratic|dot> N" << std::endl;
+    return 1;
+}
+
+bool parseKernel(const std::string& name, Kernel& kernel) {
+    if (name == "quadratic") kernel = QUADRATIC;
+    else if (name == "dot") kernel = DOT;
+    else return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    Kernel kernel;
+    std::mt19937 rng(1);
+
+    if (args.size() == 3 && args[0] == "--emit") {
+        if (!parseKernel(args[1], kernel)) return usage();
+        long n = std::atol(args[2].c_str());
+        float record[MAX_FIELDS];
+        for (long i = 0; i < n; ++i) {
+            randomRecord(kernel, rng, record);
+            for (int f = 0; f < fieldCount(kernel); ++f) std::printf(f ? " %g" : "%g", record[f]);
+            std::printf("\n");
+        }
+        return 0;
+    }
+
+    if (args.empty() || !parseKernel(args[0], kernel)) return usage();
+    int workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    std::string input = "--generate";
+    long generate = 10000000;
+    std::chrono::milliseconds flush(1);
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--workers" && i + 1 < args.size()) workers = std::max(1, std::atoi(args[++i].c_str()));
+        else if (args[i] == "--generate" && i + 1 < args.size()) generate = std::atol(args[++i].c_str());
+        else if (args[i] == "--flush-ms" && i + 1 < args.size()) flush = std::chrono::milliseconds(std::max(0, std::atoi(args[++i].c_str())));
+        else input = args[i];
+    }
+
+    if (input == "--generate") {
+        long produced = 0;
+        return runPipeline(kernel, workers, flush, [&](float* record, Clock::time_point) {
+            if (produced == generate) return FILL_END;
+            ++produced;
+            randomRecord(kernel, rng, record);
+            return FILL_RECORD;
+        });
+    }
+
+    int fd = input == "-" ? STDIN_FILENO : open(input.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << input << std::endl;
+        return 1;
+    }
+    FloatReader reader(fd);
+    const int fields = fieldCount(kernel);
+    // Fields parsed so far survive a stall, so a record split across reads is completed later
+    float pending[MAX_FIELDS];
+    int have = 0;
+    int status = runPipeline(kernel, workers, flush, [&](float* record, Clock::time_point deadline) {
+        while (have < fields) {
+            ReadStatus read = reader.next(pending[have], deadline);
+            if (read == READ_STALLED) return FILL_STALLED;
+            if (read == READ_END) return FILL_END; // a trailing partial record is dropped
+            ++have;
+        }
+        std::copy(pending, pending + fields, record);
+        have = 0;
+        return FILL_RECORD;
+    });
+    if (fd != STDIN_FILENO) close(fd);
+    return status;
+}
@@ -0,0 +1,306 @@
+#include "immintrin.h" // AVX2, 256 bit operations (8 floats)
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. Workload Generator: builds large arrays whose predicate outcomes have a chosen selectivity p
+ *    (fraction of elements that pass) and predictability:
+ *    - sorted:   all passing elements first, one branch flip in the whole array
+ *    - periodic: passing elements evenly spaced, every 1/p elements
+ *    - random:   each element passes independently with probability p
+ * 2. Kernels: the three tests of 01_conditional_code, scaled up from 8 values to whole arrays,
+ *    each in a branchy scalar, a branchless scalar and a SIMD form:
+ *    - clamp to [5, 30] (predicate: value is above the range)
+ *    - positive filter, writing the positive values contiguously (stream compaction)
+ *    - two predicates, keep data2 where data2 > 0 and data2 > data1, else 0
+ * 3. Matrix: every kernel runs on every (pattern, p) combination and reports ns per element.
+ *
+ * Focus:
+ * - With 8 fixed values the branch predictor learns every outcome, so 01_conditional_code cannot
+ *   show the cost of a mispredicted branch. Here the branchy versions slow down as the outcomes
+ *   get less predictable, while the branchless and SIMD versions do not depend on the data.
+ *
+ * The Makefile passes -fno-if-conversion / -fno-tree-vectorize so that the compiler keeps the
+ * branchy scalar versions branchy and the scalar versions scalar.
+ */
+
+enum Pattern { SORTED, PERIODIC, RANDOM };
+const char* patternNames[] = { "sorted", "periodic", "random" };
+
+//--------- Workload generator -------------//
+
+// outcome[i] is true for the elements that should pass the predicate
+std::vector<char> makeOutcomes(size_t n, double p, Pattern pattern, std::mt19937& rng) {
+    std::vector<char> outcome(n, 0);
+    if (pattern == SORTED) {
+        std::fill(outcome.begin(), outcome.begin() + static_cast<size_t>(p * n), 1);
+    } else if (pattern == PERIODIC) {
+        for (size_t i = 0; i < n; ++i) {
+            outcome[i] = static_cast<size_t>((i + 1) * p) != static_cast<size_t>(i * p);
+        }
+    } else {
+        std::bernoulli_distribution pass(p);
+        for (size_t i = 0; i < n; ++i) outcome[i] = pass(rng);
+    }
+    return outcome;
+}
+
+struct Workload {
+    std::vector<float> data1; // the second operand of the two-predicate test
+    std::vector<float> clamp; // passes: above 30
+    std::vector<float> positive; // passes: > 0
+    std::vector<float> twoPredicate; // passes: > 0 and > data1
+};
+
+Workload makeWorkload(const std::vector<char>& outcome, std::mt19937& rng) {
+    size_t n = outcome.size();
+    std::uniform_real_distribution<float> inRange(5.0f, 30.0f), above(30.1f, 80.0f);
+    std::uniform_real_distribution<float> pos(0.1f, 100.0f), neg(-100.0f, -0.1f), unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> ref(5.0f, 40.0f);
+    Workload w;
+    w.data1.resize(n);
+    w.clamp.resize(n);
+    w.positive.resize(n);
+    w.twoPredicate.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        bool pass = outcome[i] != 0;
+        // Passing values are always above the range, so only the outcome pattern decides the branch
+        w.clamp[i] = pass ? above(rng) : inRange(rng);
+        w.positive[i] = pass ? pos(rng) : neg(rng);
+        float y = ref(rng);
+        w.data1[i] = y;
+        // Failing elements are positive but not above data1, so the outcome pattern drives the second test
+        w.twoPredicate[i] = pass ? y + 1.0f + unit(rng) * 50.0f : y * (0.05f + 0.95f * unit(rng));
+    }
+    return w;
+}
+
+//--------- Clamp -------------//
+
+void clampBranchy(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] < 5.0f) out[i] = 5.0f;
+        else if (x[i] > 30.0f) out[i] = 30.0f;
+        else out[i] = x[i];
+    }
+}
+
+// Scalar minss / maxss; GCC compiles std::min / std::max on floats to branches here
+void clampMinMax(const float* x, float* out, size_t n) {
+    const __m128 lo = _mm_set_ss(5), hi = _mm_set_ss(30);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = _mm_cvtss_f32(_mm_max_ss(lo, _mm_min_ss(hi, _mm_set_ss(x[i]))));
+    }
+}
+
+void clampSimd(const float* x, float* out, size_t n) {
+    const __m256 lo = _mm256_set1_ps(5), hi = _mm256_set1_ps(30);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(lo, _mm256_min_ps(hi, _mm256_loadu_ps(x + i))));
+    }
+    clampMinMax(x + i, out + i, n - i);
+}
+
+//--------- Positive filter (stream compaction) -------------//
+
+// All filters return the number of values written; out needs n + 8 elements of room
+size_t positiveBranchy(const float* x, float* out, size_t n) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] > 0) out[k++] = x[i];
+    }
+    return k;
+}
+
+// Always store, only advance the cursor when the value passes
+size_t positiveBranchless(const float* x, float* out, size_t n) {
+    size_t k = 0;
+    for (size_t i = 0; i < n; ++i) {
+        out[k] = x[i];
+        k += x[i] > 0;
+    }
+    return k;
+}
+
+// The SIMD version from 01_conditional_code: compare + movemask, then a branch per lane
+size_t positiveMaskLoop(const float* x, float* out, size_t n) {
+    size_t k = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + i), _mm256_setzero_ps(), _CMP_GT_OQ));
+        for (int lane = 0; lane < 8; ++lane) {
+            if (mask & (1 << lane)) out[k++] = x[i + lane];
+        }
+    }
+    for (; i < n; ++i) {
+        if (x[i] > 0) out[k++] = x[i];
+    }
+    return k;
+}
+
+// For each 8-bit mask, the lane indices of the set bits moved to the front
+struct CompactionTable {
+    int32_t idx[256][8];
+    CompactionTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int k = 0;
+            for (int lane = 0; lane < 8; ++lane) {
+                if (mask & (1 << lane)) idx[mask][k++] = lane;
+            }
+            for (; k < 8; ++k) idx[mask][k] = 0;
+        }
+    }
+};
+const CompactionTable compaction;
+
+// Branchless SIMD: permute the passing lanes to the front, store all 8, advance by popcount
+size_t positiveCompress(const float* x, float* out, size_t n) {
+    size_t k = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ));
+        __m256i perm = _mm256_loadu_si256((const __m256i*)compaction.idx[mask]);
+        _mm256_storeu_ps(out + k, _mm256_permutevar8x32_ps(v, perm));
+        k += _mm_popcnt_u32(mask);
+    }
+    for (; i < n; ++i) {
+        out[k] = x[i];
+        k += x[i] > 0;
+    }
+    return k;
+}
+
+//--------- Two predicates -------------//
+
+void twoPredicateBranchy(const float* x, const float* y, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] > 0 && x[i] > y[i]) out[i] = x[i];
+        else out[i] = 0;
+    }
+}
+
+// Predicates turned into a 0/1 factor
+void twoPredicateBranchless(const float* x, const float* y, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = x[i] * static_cast<float>((x[i] > 0) & (x[i] > y[i]));
+    }
+}
+
+// "SIMD take two" from 01_conditional_code: two compares, and, blendv
+void twoPredicateSimd(const float* x, const float* y, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 posi = _mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_GT_OQ);
+        __m256 big = _mm256_cmp_ps(v, _mm256_loadu_ps(y + i), _CMP_GT_OQ);
+        _mm256_storeu_ps(out + i, _mm256_blendv_ps(_mm256_setzero_ps(), v, _mm256_and_ps(posi, big)));
+    }
+    for (; i < n; ++i) out[i] = x[i] > 0 && x[i] > y[i] ? x[i] : 0;
+}
+
+//--------- Benchmark -------------//
+
+// Average ns per element over `repeats` calls
+template<typename Func>
+double nsPerElement(Func f, size_t n, int repeats) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        f();
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / repeats / n;
+}
+
+void printHeader(const char* title, const char* const* columns, int count) {
+    std::cout << "----------- " << title << " (ns/element) ------------" << std::endl;
+    std::cout << std::left << std::setw(10) << "pattern" << std::setw(7) << "p";
+    for (int c = 0; c < count; ++c) std::cout << std::setw(14) << columns[c];
+    std::cout << std::endl;
+}
+
+void printRow(Pattern pattern, double p, const double* values, int count) {
+    std::cout << std::left << std::setw(10) << patternNames[pattern] << std::setw(7) << p << std::fixed << std::setprecision(3);
+    for (int c = 0; c < count; ++c) std::cout << std::setw(14) << values[c];
+    std::cout << std::defaultfloat << std::setprecision(6) << std::endl;
+}
+
+int main() {
+    const size_t n = 1 << 20;
+    const int repeats = 20;
+    const double selectivities[] = { 0.01, 0.05, 0.1, 0.25, 0.5 };
+    const Pattern patterns[] = { SORTED, PERIODIC, RANDOM };
+    std::mt19937 rng(13);
+
+    // Generate every workload up front so that all three tables see the same data
+    std::vector<Workload> workloads;
+    for (Pattern pattern : patterns) {
+        for (double p : selectivities) workloads.push_back(makeWorkload(makeOutcomes(n, p, pattern, rng), rng));
+    }
+
+    std::vector<float> out(n + 8), reference(n + 8);
+    bool ok = true;
+
+    const char* clampColumns[] = { "branchy", "scalar minss", "SIMD min/max" };
+    printHeader("clamp to [5, 30], p = fraction above 30", clampColumns, 3);
+    size_t w = 0;
+    for (Pattern pattern : patterns) {
+        for (double p : selectivities) {
+            const float* x = workloads[w++].clamp.data();
+            double t[3];
+            t[0] = nsPerElement([&] { clampBranchy(x, reference.data(), n); }, n, repeats);
+            t[1] = nsPerElement([&] { clampMinMax(x, out.data(), n); }, n, repeats);
+            ok = ok && std::equal(out.begin(), out.begin() + n, reference.begin());
+            t[2] = nsPerElement([&] { clampSimd(x, out.data(), n); }, n, repeats);
+            ok = ok && std::equal(out.begin(), out.begin() + n, reference.begin());
+            printRow(pattern, p, t, 3);
+        }
+    }
+
+    const char* filterColumns[] = { "branchy", "branchless", "SIMD mask+if", "SIMD compress" };
+    printHeader("positive filter, p = fraction positive", filterColumns, 4);
+    w = 0;
+    for (Pattern pattern : patterns) {
+        for (double p : selectivities) {
+            const float* x = workloads[w++].positive.data();
+            size_t expected = 0, k = 0;
+            double t[4];
+            t[0] = nsPerElement([&] { expected = positiveBranchy(x, reference.data(), n); }, n, repeats);
+            t[1] = nsPerElement([&] { k = positiveBranchless(x, out.data(), n); }, n, repeats);
+            ok = ok && k == expected && std::equal(out.begin(), out.begin() + k, reference.begin());
+            t[2] = nsPerElement([&] { k = positiveMaskLoop(x, out.data(), n); }, n, repeats);
+            ok = ok && k == expected && std::equal(out.begin(), out.begin() + k, reference.begin());
+            t[3] = nsPerElement([&] { k = positiveCompress(x, out.data(), n); }, n, repeats);
+            ok = ok && k == expected && std::equal(out.begin(), out.begin() + k, reference.begin());
+            printRow(pattern, p, t, 4);
+        }
+    }
+
+    const char* twoColumns[] = { "branchy", "branchless", "SIMD blendv" };
+    printHeader("data2 > 0 && data2 > data1, p = fraction passing", twoColumns, 3);
+    w = 0;
+    for (Pattern pattern : patterns) {
+        for (double p : selectivities) {
+            const Workload& wl = workloads[w++];
+            const float* x = wl.twoPredicate.data();
+            const float* y = wl.data1.data();
+            double t[3];
+            t[0] = nsPerElement([&] { twoPredicateBranchy(x, y, reference.data(), n); }, n, repeats);
+            t[1] = nsPerElement([&] { twoPredicateBranchless(x, y, out.data(), n); }, n, repeats);
+            ok = ok && std::equal(out.begin(), out.begin() + n, reference.begin());
+            t[2] = nsPerElement([&] { twoPredicateSimd(x, y, out.data(), n); }, n, repeats);
+            ok = ok && std::equal(out.begin(), out.begin() + n, reference.begin());
+            printRow(pattern, p, t, 3);
+        }
+    }
+
+    if (!ok) {
+        std::cerr << "Kernel variants disagree." << std::endl;
+        return 1;
+    }
+    return 0;
+}
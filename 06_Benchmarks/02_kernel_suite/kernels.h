@@ -0,0 +1,377 @@
+#ifndef KERNEL_SUITE_KERNELS_H
+#define KERNEL_SUITE_KERNELS_H
+
+#include "immintrin.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+/*
+ * The kernels of chapters 01-03, rewritten as array kernels with one fixed signature so that the
+ * suite can time them all the same way:
+ *   init:  setzero, set1
+ *   load:  aligned, unaligned, setr
+ *   arith: add, sub, mul, div, fma
+ *   dot:   SoA 3D dot product
+ *   cond:  clamp, positive filter, two predicates
+ *   quad:  quadratic equation roots
+ *
+ * Every kernel has a scalar form and a SIMD form. The SIMD forms are written against the small
+ * wrapper below, which maps to 256-bit AVX2 when the build has it and to 128-bit SSE4.1 otherwise,
+ * so the same source builds for every column of the ISA matrix in the Makefile.
+ *
+ * n must be a multiple of 8 (the suite only uses powers of two), so the SIMD kernels have no
+ * scalar tail loop.
+ * Kernels are extern "C" and noinline: each one is a separate symbol with a readable name in the
+ * binary, it cannot be folded into the timing loop, and its code can be disassembled on its own.
+ */
+
+//--------- ISA wrapper -------------//
+
+#if defined(__AVX2__)
+#define SUITE_ISA "avx2"
+typedef __m256 vfloat;
+const int W = 8;
+inline vfloat vload(const float* p) { return _mm256_load_ps(p); }
+inline vfloat vloadu(const float* p) { return _mm256_loadu_ps(p); }
+inline vfloat vsetr(const float* p) { return _mm256_setr_ps(p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]); }
+inline void vstore(float* p, vfloat v) { _mm256_store_ps(p, v); }
+inline void vstoreu(float* p, vfloat v) { _mm256_storeu_ps(p, v); }
+inline vfloat vset1(float x) { return _mm256_set1_ps(x); }
+inline vfloat vzero() { return _mm256_setzero_ps(); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+inline vfloat vdiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+inline vfloat vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm256_and_ps(a, b); }
+inline vfloat vcmpgt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline vfloat vblend(vfloat a, vfloat b, vfloat mask) { return _mm256_blendv_ps(a, b, mask); }
+inline int vmovemask(vfloat a) { return _mm256_movemask_ps(a); }
+#elif defined(__SSE4_1__)
+#define SUITE_ISA "sse"
+typedef __m128 vfloat;
+const int W = 4;
+inline vfloat vload(const float* p) { return _mm_load_ps(p); }
+inline vfloat vloadu(const float* p) { return _mm_loadu_ps(p); }
+inline vfloat vsetr(const float* p) { return _mm_setr_ps(p[0], p[1], p[2], p[3]); }
+inline void vstore(float* p, vfloat v) { _mm_store_ps(p, v); }
+inline void vstoreu(float* p, vfloat v) { _mm_storeu_ps(p, v); }
+inline vfloat vset1(float x) { return _mm_set1_ps(x); }
+inline vfloat vzero() { return _mm_setzero_ps(); }
+inline vfloat vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+inline vfloat vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+inline vfloat vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+inline vfloat vdiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+inline vfloat vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+inline vfloat vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+inline vfloat vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+inline vfloat vand(vfloat a, vfloat b) { return _mm_and_ps(a, b); }
+inline vfloat vcmpgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+inline vfloat vblend(vfloat a, vfloat b, vfloat mask) { return _mm_blendv_ps(a, b, mask); }
+inline int vmovemask(vfloat a) { return _mm_movemask_ps(a); }
+#else
+#error "the kernel suite needs at least SSE4.1"
+#endif
+
+// a * b + c, fused when the build has FMA
+#if defined(__FMA__)
+inline vfloat vfma(vfloat a, vfloat b, vfloat c) {
+#if defined(__AVX2__)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm_fmadd_ps(a, b, c);
+#endif
+}
+#else
+inline vfloat vfma(vfloat a, vfloat b, vfloat c) { return vadd(vmul(a, b), c); }
+#endif
+
+//--------- Buffers -------------//
+
+// 64-byte aligned inputs and outputs, all at least n floats long (in[1] at least n + 1, see load.unaligned)
+struct Buffers {
+    float* in[6];
+    float* out;
+    float* out2;
+};
+
+// Every kernel copies the pointers it uses into locals first. Otherwise each store through out
+// may alias the Buffers struct, and the compiler reloads the pointers on every iteration.
+#define KERNEL extern "C" __attribute__((noinline))
+
+//--------- init -------------//
+
+KERNEL void init_setzero_scalar(const Buffers& b, size_t n) {
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = 0.0f;
+}
+
+KERNEL void init_setzero_simd(const Buffers& b, size_t n) {
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vzero());
+}
+
+KERNEL void init_set1_scalar(const Buffers& b, size_t n) {
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = 10.0f;
+}
+
+KERNEL void init_set1_simd(const Buffers& b, size_t n) {
+    float* out = b.out;
+    vfloat ten = vset1(10.0f);
+    for (size_t i = 0; i < n; i += W) vstore(out + i, ten);
+}
+
+//--------- load -------------//
+
+KERNEL void load_aligned_scalar(const Buffers& b, size_t n) {
+    const float* src = b.in[0];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = src[i];
+}
+
+KERNEL void load_aligned_simd(const Buffers& b, size_t n) {
+    const float* src = b.in[0];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vload(src + i));
+}
+
+// Reads start one float past the aligned base, so every vector load is misaligned
+KERNEL void load_unaligned_scalar(const Buffers& b, size_t n) {
+    const float* src = b.in[1] + 1;
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = src[i];
+}
+
+KERNEL void load_unaligned_simd(const Buffers& b, size_t n) {
+    const float* src = b.in[1] + 1;
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vloadu(src + i));
+}
+
+// Builds each vector element by element, as 02_initializing_data does with _mm256_setr_ps
+KERNEL void load_setr_simd(const Buffers& b, size_t n) {
+    const float* src = b.in[0];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vsetr(src + i));
+}
+
+//--------- arithmetic -------------//
+
+KERNEL void arith_add_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x[i] + y[i];
+}
+
+KERNEL void arith_add_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vadd(vload(x + i), vload(y + i)));
+}
+
+KERNEL void arith_sub_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x[i] - y[i];
+}
+
+KERNEL void arith_sub_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vsub(vload(x + i), vload(y + i)));
+}
+
+KERNEL void arith_mul_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x[i] * y[i];
+}
+
+KERNEL void arith_mul_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vmul(vload(x + i), vload(y + i)));
+}
+
+KERNEL void arith_div_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x[i] / y[i];
+}
+
+KERNEL void arith_div_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vdiv(vload(x + i), vload(y + i)));
+}
+
+KERNEL void arith_fma_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1], *z = b.in[2];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x[i] * y[i] + z[i];
+}
+
+KERNEL void arith_fma_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1], *z = b.in[2];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vfma(vload(x + i), vload(y + i), vload(z + i)));
+}
+
+//--------- dot product -------------//
+
+// in[0..2] are x1, y1, z1 and in[3..5] are x2, y2, z2, one vector pair per index
+KERNEL void dot_vec3_scalar(const Buffers& b, size_t n) {
+    const float *x1 = b.in[0], *y1 = b.in[1], *z1 = b.in[2];
+    const float *x2 = b.in[3], *y2 = b.in[4], *z2 = b.in[5];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = x1[i] * x2[i] + y1[i] * y2[i] + z1[i] * z2[i];
+}
+
+KERNEL void dot_vec3_simd(const Buffers& b, size_t n) {
+    const float *x1 = b.in[0], *y1 = b.in[1], *z1 = b.in[2];
+    const float *x2 = b.in[3], *y2 = b.in[4], *z2 = b.in[5];
+    float* out = b.out;
+    for (size_t i = 0; i < n; i += W) {
+        vfloat result = vmul(vload(x1 + i), vload(x2 + i));
+        result = vfma(vload(y1 + i), vload(y2 + i), result);
+        result = vfma(vload(z1 + i), vload(z2 + i), result);
+        vstore(out + i, result);
+    }
+}
+
+//--------- conditionals -------------//
+
+KERNEL void cond_clamp_scalar(const Buffers& b, size_t n) {
+    const float* x = b.in[0];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = std::min(std::max(x[i], 5.0f), 30.0f);
+}
+
+KERNEL void cond_clamp_simd(const Buffers& b, size_t n) {
+    const float* x = b.in[0];
+    float* out = b.out;
+    vfloat lo = vset1(5.0f), hi = vset1(30.0f);
+    for (size_t i = 0; i < n; i += W) vstore(out + i, vmin(vmax(vload(x + i), lo), hi));
+}
+
+// Writes the positive values of in[0] contiguously to out; the count goes to out2[0]
+KERNEL void cond_filter_scalar(const Buffers& b, size_t n) {
+    const float* x = b.in[0];
+    float* out = b.out;
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] > 0.0f) out[count++] = x[i];
+    }
+    b.out2[0] = static_cast<float>(count);
+}
+
+KERNEL void cond_filter_simd(const Buffers& b, size_t n) {
+    const float* x = b.in[0];
+    float* out = b.out;
+    vfloat zero = vzero();
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += W) {
+        int mask = vmovemask(vcmpgt(vload(x + i), zero));
+        while (mask) {
+            out[count++] = x[i + __builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+    }
+    b.out2[0] = static_cast<float>(count);
+}
+
+// out[i] = in[1][i] where in[1][i] > 0 and in[1][i] > in[0][i], else 0
+KERNEL void cond_two_predicate_scalar(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    for (size_t i = 0; i < n; ++i) out[i] = (y[i] > 0.0f && y[i] > x[i]) ? y[i] : 0.0f;
+}
+
+KERNEL void cond_two_predicate_simd(const Buffers& b, size_t n) {
+    const float *x = b.in[0], *y = b.in[1];
+    float* out = b.out;
+    vfloat zero = vzero();
+    for (size_t i = 0; i < n; i += W) {
+        vfloat vx = vload(x + i), vy = vload(y + i);
+        vfloat mask = vand(vcmpgt(vy, zero), vcmpgt(vy, vx));
+        vstore(out + i, vblend(zero, vy, mask));
+    }
+}
+
+//--------- quadratic equations -------------//
+
+// Roots of a x^2 + b x + c with a = in[0], b = in[1], c = in[2]; NaN where the discriminant is negative
+KERNEL void quad_roots_scalar(const Buffers& b, size_t n) {
+    const float *qa = b.in[0], *qb = b.in[1], *qc = b.in[2];
+    float *out = b.out, *out2 = b.out2;
+    for (size_t i = 0; i < n; ++i) {
+        float root = std::sqrt(qb[i] * qb[i] - 4.0f * qa[i] * qc[i]);
+        out[i] = (-qb[i] + root) / (2.0f * qa[i]);
+        out2[i] = (-qb[i] - root) / (2.0f * qa[i]);
+    }
+}
+
+KERNEL void quad_roots_simd(const Buffers& b, size_t n) {
+    const float *qa = b.in[0], *qb = b.in[1], *qc = b.in[2];
+    float *out = b.out, *out2 = b.out2;
+    vfloat four = vset1(4.0f), two = vset1(2.0f), zero = vzero();
+    for (size_t i = 0; i < n; i += W) {
+        vfloat a = vload(qa + i), bb = vload(qb + i), c = vload(qc + i);
+        vfloat root = vsqrt(vsub(vmul(bb, bb), vmul(four, vmul(a, c))));
+        vfloat denom = vmul(two, a);
+        vfloat negB = vsub(zero, bb);
+        vstore(out + i, vdiv(vadd(negB, root), denom));
+        vstore(out2 + i, vdiv(vsub(negB, root), denom));
+    }
+}
+
+//--------- Registry -------------//
+
+struct Kernel {
+    const char* name; // group.kernel.form, the key used in the JSON results
+    const char* symbol; // function name in the binary
+    bool vectorized; // written with SIMD intrinsics; the scalar forms are whatever the compiler makes of them
+    void (*run)(const Buffers&, size_t);
+};
+
+#define REGISTER(name, fn, vectorized) { name, #fn, vectorized, fn }
+
+const Kernel kernels[] = {
+    REGISTER("init.setzero.scalar", init_setzero_scalar, false),
+    REGISTER("init.setzero.simd", init_setzero_simd, true),
+    REGISTER("init.set1.scalar", init_set1_scalar, false),
+    REGISTER("init.set1.simd", init_set1_simd, true),
+    REGISTER("load.aligned.scalar", load_aligned_scalar, false),
+    REGISTER("load.aligned.simd", load_aligned_simd, true),
+    REGISTER("load.unaligned.scalar", load_unaligned_scalar, false),
+    REGISTER("load.unaligned.simd", load_unaligned_simd, true),
+    REGISTER("load.setr.simd", load_setr_simd, true),
+    REGISTER("arith.add.scalar", arith_add_scalar, false),
+    REGISTER("arith.add.simd", arith_add_simd, true),
+    REGISTER("arith.sub.scalar", arith_sub_scalar, false),
+    REGISTER("arith.sub.simd", arith_sub_simd, true),
+    REGISTER("arith.mul.scalar", arith_mul_scalar, false),
+    REGISTER("arith.mul.simd", arith_mul_simd, true),
+    REGISTER("arith.div.scalar", arith_div_scalar, false),
+    REGISTER("arith.div.simd", arith_div_simd, true),
+    REGISTER("arith.fma.scalar", arith_fma_scalar, false),
+    REGISTER("arith.fma.simd", arith_fma_simd, true),
+    REGISTER("dot.vec3.scalar", dot_vec3_scalar, false),
+    REGISTER("dot.vec3.simd", dot_vec3_simd, true),
+    REGISTER("cond.clamp.scalar", cond_clamp_scalar, false),
+    REGISTER("cond.clamp.simd", cond_clamp_simd, true),
+    REGISTER("cond.filter.scalar", cond_filter_scalar, false),
+    REGISTER("cond.filter.simd", cond_filter_simd, true),
+    REGISTER("cond.two_predicate.scalar", cond_two_predicate_scalar, false),
+    REGISTER("cond.two_predicate.simd", cond_two_predicate_simd, true),
+    REGISTER("quad.roots.scalar", quad_roots_scalar, false),
+    REGISTER("quad.roots.simd", quad_roots_simd, true),
+};
+
+const size_t kernelCount = sizeof(kernels) / sizeof(kernels[0]);
+
+#endif
@@ -0,0 +1,677 @@
+#include "kernels.h"
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. Kernels (kernels.h): every kernel of chapters 01-03 as a scalar and a SIMD array kernel,
+ *    registered in one table.
+ * 2. Runner: checks each SIMD kernel against its scalar form, then times every kernel at an L1,
+ *    an L2 and a DRAM sized problem. Each measurement is a number of samples (three times as many
+ *    at the DRAM size); the median is the reported result and the minimum the one compare uses.
+ *    The samples are also cut into groups of three, and the spread of the group minimums is the
+ *    noise of the minimum.
+ * 3. JSON results: one file per build, keyed by kernel name and size. merge combines several
+ *    runs of a build, each its own process, into one file whose noise is the spread of the
+ *    per-run minimums; the bench target runs every build five times, interleaved.
+ * 4. Compare: diffs a run against a saved baseline on the minimum time, beyond the change all
+ *    kernels of that size share, and flags the kernels that got slower by more than the noise of the
+ *    two runs. A flagged kernel is timed again when the compare runs in the same build that wrote the
+ *    current results, and only counts as a regression when the slowdown reproduces. A size at
+ *    which the whole suite moved by more than twice the threshold is inconclusive and does not
+ *    fail.
+ *
+ * Usage:
+ *   suite run [--out FILE] [--filter TEXT] [--samples N]
+ *   suite list
+ *   suite merge --out FILE RUN.json [RUN.json ...]
+ *   suite compare BASELINE.json CURRENT.json [--threshold PERCENT]
+ *
+ * The Makefile builds this file once per optimization level (-O2, -O3) and ISA (SSE4.1, AVX2,
+ * native), and its bench / baseline / compare targets run the whole matrix. bench first runs
+ * the audit target, which checks the generated code of every build with 03_codegen_audit.
+ */
+
+#ifndef SUITE_VARIANT
+#define SUITE_VARIANT "custom"
+#endif
+
+const size_t problemSizes[] = { 1 << 10, 1 << 16, 1 << 22 }; // 4 KB per array (L1), 256 KB (L2), 16 MB (DRAM)
+const size_t maxSize = 1 << 22;
+const double sampleNs = 2e6; // each sample runs the kernel for at least 2 ms
+const int dramSampleFactor = 3; // DRAM bound kernels are the noisiest; take more samples there
+const int minGroup = 3; // samples per group when estimating the noise of the minimum
+
+//--------- Buffers -------------//
+
+float* allocFloats(size_t n) {
+    return static_cast<float*>(aligned_alloc(64, ((n * sizeof(float) + 63) / 64) * 64));
+}
+
+// Inputs chosen so that every kernel does real work: in[0] has values below, inside and above the
+// clamp range and of both signs, in[1] is never zero, and most quadratics have real roots.
+Buffers makeBuffers(size_t n) {
+    Buffers b;
+    for (int k = 0; k < 6; ++k) b.in[k] = allocFloats(n + W);
+    b.out = allocFloats(n);
+    b.out2 = allocFloats(n);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> wide(-40.0f, 40.0f), divisor(1.0f, 2.0f), centered(-10.0f, 10.0f);
+    for (size_t i = 0; i < n + W; ++i) {
+        b.in[0][i] = i % 4 == 0 ? divisor(rng) : wide(rng);
+        b.in[1][i] = (i % 2 ? -1.0f : 1.0f) * divisor(rng) * 8.0f;
+        b.in[2][i] = centered(rng) * 0.5f;
+        b.in[3][i] = centered(rng);
+        b.in[4][i] = centered(rng);
+        b.in[5][i] = centered(rng);
+    }
+    // quad.roots divides by in[0]; keep it away from zero
+    for (size_t i = 0; i < n + W; ++i) {
+        if (std::fabs(b.in[0][i]) < 0.5f) b.in[0][i] += 1.0f;
+    }
+    std::memset(b.out, 0, n * sizeof(float));
+    std::memset(b.out2, 0, n * sizeof(float));
+    return b;
+}
+
+void freeBuffers(Buffers& b) {
+    for (int k = 0; k < 6; ++k) free(b.in[k]);
+    free(b.out);
+    free(b.out2);
+}
+
+const Kernel* findKernel(const std::string& name) {
+    for (size_t k = 0; k < kernelCount; ++k) {
+        if (name == kernels[k].name) return &kernels[k];
+    }
+    return nullptr;
+}
+
+//--------- Verification -------------//
+
+bool closeEnough(float a, float b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+    // fma may be fused in one form and not the other
+    return std::fabs(a - b) <= 1e-4f * std::max(1.0f, std::fabs(a));
+}
+
+// Runs each SIMD kernel and its scalar form on the same inputs and compares out / out2
+bool verifyKernels(Buffers& b, size_t n) {
+    std::vector<float> expected(n), expected2(n);
+    bool ok = true;
+    for (size_t k = 0; k < kernelCount; ++k) {
+        if (!kernels[k].vectorized) continue;
+        std::string scalarName = kernels[k].name;
+        scalarName.replace(scalarName.rfind(".simd"), 5, ".scalar");
+        const Kernel* scalar = findKernel(scalarName);
+        if (!scalar) continue;
+
+        std::memset(b.out2, 0, n * sizeof(float));
+        scalar->run(b, n);
+        std::copy(b.out, b.out + n, expected.begin());
+        std::copy(b.out2, b.out2 + n, expected2.begin());
+        std::memset(b.out, 0, n * sizeof(float));
+        std::memset(b.out2, 0, n * sizeof(float));
+        kernels[k].run(b, n);
+
+        // the filter kernels only write out[0..count) and the count to out2[0]
+        size_t checked = std::strncmp(kernels[k].name, "cond.filter", 11) == 0 ? static_cast<size_t>(expected2[0]) : n;
+        bool match = closeEnough(expected2[0], b.out2[0]);
+        for (size_t i = 0; i < checked && match; ++i) {
+            match = closeEnough(expected[i], b.out[i]) && closeEnough(expected2[i], b.out2[i]);
+        }
+        if (!match) {
+            std::cerr << "Mismatch: " << kernels[k].name << " differs from " << scalarName << std::endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+//--------- Timing -------------//
+
+struct Result {
+    std::string kernel;
+    size_t size;
+    double medianNs; // per call
+    double minNs;
+    double madNs;
+    double minSpread; // relative range of the minimums of groups of minGroup samples
+    int samples;
+};
+
+// Problems of 4 MB per array and up no longer fit in any cache level
+int samplesAt(size_t n, int samples) {
+    return n * sizeof(float) >= (4u << 20) ? samples * dramSampleFactor : samples;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+// Warm-up call, which also estimates how many back-to-back calls fill one sample
+long calibrateReps(const Kernel& kernel, const Buffers& b, size_t n) {
+    auto start = std::chrono::high_resolution_clock::now();
+    kernel.run(b, n);
+    double once = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count();
+    return std::max(1L, static_cast<long>(sampleNs / std::max(once, 1.0)));
+}
+
+// One sample: ns per call, averaged over reps calls
+double timeSample(const Kernel& kernel, const Buffers& b, size_t n, long reps) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (long r = 0; r < reps; ++r) kernel.run(b, n);
+    return std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - start).count() / reps;
+}
+
+Result summarize(const char* kernel, size_t n, const std::vector<double>& perCall) {
+    Result result;
+    result.kernel = kernel;
+    result.size = n;
+    result.medianNs = median(perCall);
+    result.minNs = *std::min_element(perCall.begin(), perCall.end());
+    std::vector<double> deviation(perCall.size());
+    for (size_t s = 0; s < perCall.size(); ++s) deviation[s] = std::fabs(perCall[s] - result.medianNs);
+    result.madNs = median(deviation);
+    // Consecutive samples are a round apart in time, so each group sees a different spell of the
+    // machine; how far its minimums scatter is how far the overall minimum moves between runs.
+    std::vector<double> groupMins;
+    for (size_t s = 0; s + minGroup <= perCall.size(); s += minGroup) {
+        groupMins.push_back(*std::min_element(perCall.begin() + s, perCall.begin() + s + minGroup));
+    }
+    result.minSpread = groupMins.size() < 2 ? 0.0
+        : (*std::max_element(groupMins.begin(), groupMins.end()) - *std::min_element(groupMins.begin(), groupMins.end())) / result.minNs;
+    result.samples = static_cast<int>(perCall.size());
+    return result;
+}
+
+// Times every kernel in selected at size n. Samples are taken in rounds over all kernels rather
+// than all samples of one kernel at once, so a slow spell of the machine spreads over every
+// kernel's samples and shows up in its noise instead of shifting a few kernels' results.
+std::vector<Result> timeInRounds(const std::vector<const Kernel*>& selected, const Buffers& b, size_t n, int samples) {
+    std::vector<long> reps(selected.size());
+    for (size_t k = 0; k < selected.size(); ++k) reps[k] = calibrateReps(*selected[k], b, n);
+    std::vector<std::vector<double>> perCall(selected.size());
+    for (int s = 0; s < samplesAt(n, samples); ++s) {
+        for (size_t k = 0; k < selected.size(); ++k) perCall[k].push_back(timeSample(*selected[k], b, n, reps[k]));
+    }
+    std::vector<Result> results;
+    for (size_t k = 0; k < selected.size(); ++k) results.push_back(summarize(selected[k]->name, n, perCall[k]));
+    return results;
+}
+
+//--------- JSON -------------//
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& os, const std::vector<Result>& results, int samples, int runs = 1) {
+    os << std::setprecision(6);
+    os << "{\n";
+    os << "  \"build\": {\"variant\": \"" << SUITE_VARIANT << "\", \"isa\": \"" << SUITE_ISA
+       << "\", \"vector_width\": " << W << ", \"compiler\": \"" << jsonEscape(__VERSION__)
+       << "\", \"samples\": " << samples << ", \"runs\": " << runs << "},\n";
+    os << "  \"results\": [\n";
+    for (size_t r = 0; r < results.size(); ++r) {
+        const Result& res = results[r];
+        os << "    {\"kernel\": \"" << res.kernel << "\", \"size\": " << res.size
+           << ", \"median_ns\": " << res.medianNs << ", \"min_ns\": " << res.minNs
+           << ", \"mad_ns\": " << res.madNs << ", \"min_spread\": " << res.minSpread << ", \"samples\": " << res.samples
+           << ", \"ns_per_element\": " << res.medianNs / res.size << "}"
+           << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// Just enough of a JSON reader for the files writeJson produces
+struct Json {
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    double number = 0;
+    std::string text;
+    std::vector<Json> items;
+    std::vector<std::pair<std::string, Json>> fields;
+
+    const Json* get(const std::string& key) const {
+        for (const auto& field : fields) {
+            if (field.first == key) return &field.second;
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : s(text), pos(0) {}
+
+    Json parse() {
+        Json value = parseValue();
+        skipSpace();
+        if (pos != s.size()) fail("trailing characters");
+        return value;
+    }
+
+private:
+    const std::string& s;
+    size_t pos;
+
+    void fail(const char* what) {
+        std::ostringstream message;
+        message << "JSON error at offset " << pos << ": " << what;
+        throw std::runtime_error(message.str());
+    }
+
+    void skipSpace() {
+        while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+
+    void expect(char c) {
+        skipSpace();
+        if (pos >= s.size() || s[pos] != c) fail("unexpected character");
+        ++pos;
+    }
+
+    std::string parseString() {
+        expect('"');
+        std::string result;
+        while (pos < s.size() && s[pos] != '"') {
+            if (s[pos] == '\\' && pos + 1 < s.size()) ++pos;
+            result += s[pos++];
+        }
+        expect('"');
+        return result;
+    }
+
+    Json parseValue() {
+        skipSpace();
+        if (pos >= s.size()) fail("unexpected end");
+        Json value;
+        char c = s[pos];
+        if (c == '{') {
+            value.type = Json::OBJECT;
+            ++pos;
+            skipSpace();
+            if (s[pos] == '}') { ++pos; return value; }
+            do {
+                std::string key = parseString();
+                expect(':');
+                value.fields.emplace_back(key, parseValue());
+                skipSpace();
+            } while (s[pos] == ',' && ++pos);
+            expect('}');
+        } else if (c == '[') {
+            value.type = Json::ARRAY;
+            ++pos;
+            skipSpace();
+            if (s[pos] == ']') { ++pos; return value; }
+            do {
+                value.items.push_back(parseValue());
+                skipSpace();
+            } while (s[pos] == ',' && ++pos);
+            expect(']');
+        } else if (c == '"') {
+            value.type = Json::STRING;
+            value.text = parseString();
+        } else if (s.compare(pos, 4, "true") == 0 || s.compare(pos, 5, "false") == 0) {
+            value.type = Json::BOOL;
+            value.number = s[pos] == 't';
+            pos += s[pos] == 't' ? 4 : 5;
+        } else if (s.compare(pos, 4, "null") == 0) {
+            pos += 4;
+        } else {
+            value.type = Json::NUMBER;
+            char* end;
+            value.number = std::strtod(s.c_str() + pos, &end);
+            if (end == s.c_str() + pos) fail("expected a value");
+            pos = end - s.c_str();
+        }
+        return value;
+    }
+};
+
+Json readJson(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return JsonParser(contents.str()).parse();
+}
+
+//--------- Commands -------------//
+
+// One row per kernel, one column per problem size; results hold each kernel's sizes in a row
+void printTable(const std::vector<Result>& results) {
+    std::cout << "Build " << SUITE_VARIANT << " (" << SUITE_ISA << ", " << W << " floats per vector)" << std::endl;
+    std::cout << std::left << std::setw(28) << "kernel" << std::right;
+    for (size_t n : problemSizes) std::cout << std::setw(12) << ("n=" + std::to_string(n));
+    std::cout << "   ns/element (median)" << std::endl;
+    for (size_t r = 0; r < results.size(); ++r) {
+        if (r == 0 || results[r].kernel != results[r - 1].kernel) {
+            if (r) std::cout << std::endl;
+            std::cout << std::left << std::setw(28) << results[r].kernel << std::right;
+        }
+        std::cout << std::setw(12) << std::fixed << std::setprecision(3) << results[r].medianNs / results[r].size;
+    }
+    if (!results.empty()) std::cout << std::endl;
+}
+
+bool saveJson(const std::string& outPath, const std::vector<Result>& results, int samples, int runs) {
+    std::ofstream file(outPath);
+    if (!file) {
+        std::cerr << "Cannot write " << outPath << std::endl;
+        return false;
+    }
+    writeJson(file, results, samples, runs);
+    std::cout << "Results written to " << outPath << std::endl;
+    return true;
+}
+
+int runSuite(const std::string& outPath, const std::string& filter, int samples) {
+    Buffers b = makeBuffers(maxSize);
+    if (!verifyKernels(b, 4096)) {
+        freeBuffers(b);
+        return 1;
+    }
+
+    std::vector<const Kernel*> selected;
+    for (size_t k = 0; k < kernelCount; ++k) {
+        if (filter.empty() || std::string(kernels[k].name).find(filter) != std::string::npos) selected.push_back(&kernels[k]);
+    }
+
+    const size_t sizeCount = sizeof(problemSizes) / sizeof(problemSizes[0]);
+    std::vector<Result> results(selected.size() * sizeCount);
+    for (size_t si = 0; si < sizeCount; ++si) {
+        std::vector<Result> atSize = timeInRounds(selected, b, problemSizes[si], samples);
+        for (size_t k = 0; k < selected.size(); ++k) results[k * sizeCount + si] = atSize[k];
+    }
+
+    freeBuffers(b);
+    printTable(results);
+    if (!outPath.empty() && !saveJson(outPath, results, samples, 1)) return 1;
+    return 0;
+}
+
+int listKernels() {
+    for (size_t k = 0; k < kernelCount; ++k) {
+        std::cout << kernels[k].name << " " << kernels[k].symbol << " "
+                  << (kernels[k].vectorized ? "vectorized" : "scalar") << std::endl;
+    }
+    return 0;
+}
+
+struct Measurement {
+    double medianNs;
+    double minNs;
+    double madNs;
+    double minSpread;
+    int samples;
+};
+
+typedef std::map<std::pair<std::string, size_t>, Measurement> ResultMap;
+
+ResultMap loadResults(const Json& doc) {
+    ResultMap results;
+    const Json* list = doc.get("results");
+    if (!list) throw std::runtime_error("no \"results\" array");
+    for (const Json& entry : list->items) {
+        const Json* kernel = entry.get("kernel");
+        const Json* size = entry.get("size");
+        const Json* med = entry.get("median_ns");
+        const Json* min = entry.get("min_ns");
+        const Json* mad = entry.get("mad_ns");
+        const Json* spread = entry.get("min_spread");
+        const Json* samples = entry.get("samples");
+        if (!kernel || !size || !med || !min || !mad || !spread || !samples) throw std::runtime_error("incomplete result entry");
+        results[std::make_pair(kernel->text, static_cast<size_t>(size->number))] = {
+            med->number, min->number, mad->number, spread->number, static_cast<int>(samples->number) };
+    }
+    return results;
+}
+
+std::string buildVariant(const Json& doc) {
+    const Json* build = doc.get("build");
+    const Json* variant = build ? build->get("variant") : nullptr;
+    return variant ? variant->text : "unknown";
+}
+
+int buildSamples(const Json& doc) {
+    const Json* build = doc.get("build");
+    const Json* samples = build ? build->get("samples") : nullptr;
+    return samples ? std::max(1, static_cast<int>(samples->number)) : 9;
+}
+
+// Combines several runs of this build, each a separate process, into one result file. Within one
+// process the minimum hardly moves, but between processes it can move by tens of percent: buffers
+// land on other physical pages and the machine is in another state. The spread of the per-run
+// minimums is therefore the noise of the minimum; a single run only has its group minimums.
+int mergeRuns(const std::string& outPath, const std::vector<std::string>& paths) {
+    std::vector<ResultMap> runs;
+    Json first = readJson(paths[0]);
+    for (const std::string& path : paths) {
+        Json doc = readJson(path);
+        if (buildVariant(doc) != SUITE_VARIANT) {
+            throw std::runtime_error(path + " is from build " + buildVariant(doc) + ", not " + SUITE_VARIANT);
+        }
+        runs.push_back(loadResults(doc));
+    }
+
+    std::vector<Result> results;
+    for (const Json& entry : first.get("results")->items) {
+        auto key = std::make_pair(entry.get("kernel")->text, static_cast<size_t>(entry.get("size")->number));
+        std::vector<double> medians, mins, mads, spreads;
+        Result res;
+        res.kernel = key.first;
+        res.size = key.second;
+        res.samples = 0;
+        for (size_t r = 0; r < runs.size(); ++r) {
+            auto found = runs[r].find(key);
+            if (found == runs[r].end()) throw std::runtime_error(key.first + " missing from " + paths[r]);
+            medians.push_back(found->second.medianNs);
+            mins.push_back(found->second.minNs);
+            mads.push_back(found->second.madNs);
+            spreads.push_back(found->second.minSpread);
+            res.samples += found->second.samples;
+        }
+        res.medianNs = median(medians);
+        res.minNs = *std::min_element(mins.begin(), mins.end());
+        res.madNs = median(mads);
+        res.minSpread = runs.size() < 2 ? spreads[0] : (*std::max_element(mins.begin(), mins.end()) - res.minNs) / res.minNs;
+        results.push_back(res);
+    }
+    printTable(results);
+    std::cout << "Merged " << runs.size() << " run(s)" << std::endl;
+    return saveJson(outPath, results, buildSamples(first), static_cast<int>(runs.size())) ? 0 : 1;
+}
+
+// Geometric mean of run / baseline minimum over the results both have at one size. A shift shared
+// by every kernel of a size is a busier or slower-clocked machine; a code change moves a few
+// kernels and barely moves the mean. Sizes get their own shift because a change of the machine
+// reaches them unequally: an idle sibling hyperthread speeds up L1 loops, not DRAM streams.
+double sharedShift(const ResultMap& baseline, const ResultMap& run, size_t size) {
+    double logSum = 0;
+    int count = 0;
+    for (const auto& entry : run) {
+        auto base = baseline.find(entry.first);
+        if (base == baseline.end() || entry.first.second != size) continue;
+        logSum += std::log(entry.second.minNs / base->second.minNs);
+        ++count;
+    }
+    return count ? std::exp(logSum / count) : 1.0;
+}
+
+// How much a kernel changed, in a way no shift of the machine explains: the smaller of its raw
+// change and its change net of the shared shift, or zero when the two disagree in sign. Net alone
+// is not enough, because a faster machine does not speed up every kernel alike (a divider-bound
+// loop gains nothing from an idle sibling hyperthread) and would make those look slower.
+double changeBeyondShift(double ratio, double shift) {
+    double raw = ratio - 1.0, net = ratio / shift - 1.0;
+    if ((raw > 0) != (net > 0)) return 0.0;
+    return std::fabs(raw) < std::fabs(net) ? raw : net;
+}
+
+// A kernel regresses when its minimum time grew, beyond the shift of its size, by more than the
+// threshold and by more than the spread of the group minimums of both runs, so kernels whose
+// minimum jitters need a bigger change. When this binary built the current results, every size
+// with a flagged kernel is timed again and only a slowdown that shows up in the re-run too is a
+// regression. A shift beyond twice the threshold says the machine changed under the runs (on a
+// shared host one state can be 2x faster at L1 than the other), so that size is reported as
+// inconclusive and does not fail the comparison.
+int compareRuns(const std::string& baselinePath, const std::string& currentPath, double thresholdPct) {
+    Json baselineDoc = readJson(baselinePath), currentDoc = readJson(currentPath);
+    ResultMap baseline = loadResults(baselineDoc);
+    ResultMap current = loadResults(currentDoc);
+    if (buildVariant(baselineDoc) != buildVariant(currentDoc)) {
+        std::cout << "Note: comparing build " << buildVariant(currentDoc) << " against baseline build "
+                  << buildVariant(baselineDoc) << std::endl;
+    }
+    auto outOfBounds = [&](double shift) { return std::fabs(shift - 1.0) > 2.0 * thresholdPct / 100.0; };
+    auto noiseOf = [&](const ResultMap& run, const ResultMap::key_type& key) {
+        return std::max(thresholdPct / 100.0, baseline.at(key).minSpread + run.at(key).minSpread);
+    };
+    std::map<size_t, double> shift;
+    for (const auto& entry : current) shift[entry.first.second] = 1.0;
+    for (auto& size : shift) size.second = sharedShift(baseline, current, size.first);
+
+    std::set<size_t> flaggedSizes;
+    for (const auto& entry : current) {
+        size_t size = entry.first.second;
+        if (!baseline.count(entry.first) || outOfBounds(shift[size])) continue;
+        double change = changeBeyondShift(entry.second.minNs / baseline.at(entry.first).minNs, shift[size]);
+        if (change > noiseOf(current, entry.first)) flaggedSizes.insert(size);
+    }
+    ResultMap rerun;
+    if (!flaggedSizes.empty() && buildVariant(currentDoc) != SUITE_VARIANT) {
+        std::cout << "Note: current results are not from this build (" << SUITE_VARIANT
+                  << "), flagged kernels are not re-checked" << std::endl;
+    } else if (!flaggedSizes.empty()) {
+        Buffers b = makeBuffers(maxSize);
+        for (size_t n : flaggedSizes) {
+            std::vector<const Kernel*> selected;
+            for (const auto& entry : current) {
+                const Kernel* kernel = findKernel(entry.first.first);
+                if (entry.first.second == n && n <= maxSize && kernel && baseline.count(entry.first)) selected.push_back(kernel);
+            }
+            for (const Result& res : timeInRounds(selected, b, n, buildSamples(currentDoc))) {
+                rerun[std::make_pair(res.kernel, n)] = { res.medianNs, res.minNs, res.madNs, res.minSpread, res.samples };
+            }
+        }
+        freeBuffers(b);
+    }
+    std::map<size_t, double> rerunShift;
+    for (size_t n : flaggedSizes) rerunShift[n] = sharedShift(baseline, rerun, n);
+
+    std::cout << std::left << std::setw(28) << "kernel" << std::right << std::setw(10) << "size"
+              << std::setw(14) << "base min/el" << std::setw(14) << "now min/el" << std::setw(10) << "change"
+              << std::setw(10) << "noise" << "  status" << std::endl;
+    int regressions = 0, improvements = 0;
+    for (const auto& entry : current) {
+        const std::string& kernel = entry.first.first;
+        size_t size = entry.first.second;
+        std::cout << std::left << std::setw(28) << kernel << std::right << std::setw(10) << size;
+        auto base = baseline.find(entry.first);
+        if (base == baseline.end()) {
+            std::cout << std::setw(14) << "-" << std::setw(14) << entry.second.minNs / size << "  new" << std::endl;
+            continue;
+        }
+        double change = changeBeyondShift(entry.second.minNs / base->second.minNs, shift[size]);
+        double noise = noiseOf(current, entry.first);
+        std::string status = "ok";
+        if (change > noise && outOfBounds(shift[size])) {
+            status = "slower (inconclusive)";
+        } else if (change > noise && rerun.count(entry.first)) {
+            // the re-run is taken later, maybe in another state of the machine: use its own shift
+            double again = changeBeyondShift(rerun.at(entry.first).minNs / base->second.minNs, rerunShift[size]);
+            std::ostringstream note;
+            note << std::fixed << std::setprecision(1) << std::showpos << again * 100.0 << "%";
+            if (outOfBounds(rerunShift[size])) {
+                status = "slower (re-run " + note.str() + ", inconclusive)";
+            } else if (again > noiseOf(rerun, entry.first)) {
+                status = "REGRESSION (re-run " + note.str() + ")";
+                ++regressions;
+            } else {
+                status = "ok (re-run " + note.str() + ")";
+            }
+        } else if (change > noise) {
+            status = "REGRESSION";
+            ++regressions;
+        } else if (change < -noise) {
+            status = "faster";
+            ++improvements;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(14) << base->second.minNs / size << std::setw(14)
+                  << entry.second.minNs / size << std::setprecision(1) << std::setw(9) << std::showpos << change * 100.0
+                  << "%" << std::noshowpos << std::setw(9) << noise * 100.0 << "%  " << status << std::endl;
+    }
+    for (const auto& entry : baseline) {
+        if (current.find(entry.first) == current.end()) {
+            std::cout << std::left << std::setw(28) << entry.first.first << std::right << std::setw(10)
+                      << entry.first.second << "  missing from current run" << std::endl;
+        }
+    }
+    for (const auto& size : shift) {
+        std::cout << "Shared shift at n=" << size.first << ": " << std::showpos << std::setprecision(1)
+                  << (size.second - 1.0) * 100.0 << "%" << std::noshowpos;
+        if (outOfBounds(size.second)) {
+            std::cout << " - inconclusive, more than " << 2.0 * thresholdPct
+                      << "%; check the machine or re-take the baseline";
+        }
+        std::cout << std::endl;
+    }
+    std::cout << regressions << " regression(s), " << improvements << " improvement(s)" << std::endl;
+    return regressions ? 1 : 0;
+}
+
+void usage() {
+    std::cerr << "usage: suite run [--out FILE] [--filter TEXT] [--samples N]\n"
+              << "       suite list\n"
+              << "       suite merge --out FILE RUN.json [RUN.json ...]\n"
+              << "       suite compare BASELINE.json CURRENT.json [--threshold PERCENT]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "run";
+    std::vector<std::string> positional;
+    std::string outPath, filter;
+    int samples = 9;
+    double thresholdPct = 10.0;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--samples" && i + 1 < argc) samples = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threshold" && i + 1 < argc) thresholdPct = std::atof(argv[++i]);
+        else positional.push_back(arg);
+    }
+
+    try {
+        if (command == "run" && positional.empty()) return runSuite(outPath, filter, samples);
+        if (command == "list" && positional.empty()) return listKernels();
+        if (command == "merge" && !outPath.empty() && !positional.empty()) return mergeRuns(outPath, positional);
+        if (command == "compare" && positional.size() == 2) return compareRuns(positional[0], positional[1], thresholdPct);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    usage();
+    return 1;
+}
@@ -0,0 +1,267 @@
+#include "../02_kernel_suite/kernels.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Key Components:
+ * 1. Assembly reader: reads the GCC assembly (AT&T syntax) that the kernel suite's asm target
+ *    emits for each build, and cuts out the body of every kernel in the registry.
+ * 2. Loop finder: every conditional jump back to a label earlier in the same function closes a
+ *    loop; the instructions between the label and the jump are the loop body. The hot code of a
+ *    kernel is the union of its loop bodies. Out-of-line blocks (slow paths the compiler moved
+ *    after the return) are not part of it.
+ * 3. Instruction mix: each hot instruction is classified as packed FP, scalar FP, load, store,
+ *    shuffle, gather, divide/square root and spill (stack access). One instruction can count in
+ *    several columns, e.g. vaddps (%rax), %ymm1, %ymm0 is both packed FP and a load.
+ * 4. Verdict: a kernel registered as vectorized fails when its hot code contains scalar FP
+ *    arithmetic. Kernels without a loop (eliminated, or turned into a memset call) and scalar
+ *    kernels the compiler auto-vectorized are reported but do not fail.
+ *
+ * Usage:
+ *   codegen_audit SUITE.s [SUITE.s ...]
+ * Exits with 1 when any kernel fails or cannot be found, so `make audit` in 02_kernel_suite
+ * stops before benchmarking a build whose SIMD kernels no longer compile to SIMD code.
+ */
+
+//--------- Assembly reader -------------//
+
+struct Instruction {
+    std::string mnemonic; // without the v prefix of the VEX/EVEX forms
+    std::vector<std::string> operands; // AT&T order: sources first, destination last
+    std::string text;
+};
+
+struct Function {
+    std::vector<Instruction> code;
+    std::map<std::string, size_t> labels; // label -> index of the next instruction
+    bool framePointer = false;
+};
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    size_t end = s.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : s.substr(begin, end - begin + 1);
+}
+
+// Splits "8(%rsi,%rax,4), %ymm2, %ymm0" at the commas outside parentheses
+std::vector<std::string> splitOperands(const std::string& text) {
+    std::vector<std::string> operands;
+    std::string current;
+    int depth = 0;
+    for (char c : text) {
+        if (c == '(') ++depth;
+        if (c == ')') --depth;
+        if (c == ',' && depth == 0) {
+            operands.push_back(trim(current));
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    if (!trim(current).empty()) operands.push_back(trim(current));
+    return operands;
+}
+
+const std::set<std::string> prefixes = { "rep", "repz", "repnz", "repe", "repne", "lock", "notrack" };
+
+Instruction parseInstruction(const std::string& line) {
+    Instruction ins;
+    ins.text = trim(line);
+    std::replace(ins.text.begin(), ins.text.end(), '\t', ' ');
+    std::string rest = ins.text;
+    do {
+        size_t space = rest.find_first_of(" \t");
+        ins.mnemonic = rest.substr(0, space);
+        rest = space == std::string::npos ? "" : trim(rest.substr(space));
+    } while (prefixes.count(ins.mnemonic) && !rest.empty());
+    // vaddps -> addps, but keep the few general purpose mnemonics that start with v
+    if (ins.mnemonic.size() > 3 && ins.mnemonic[0] == 'v' && ins.mnemonic != "verr" && ins.mnemonic != "verw") {
+        ins.mnemonic = ins.mnemonic.substr(1);
+    }
+    ins.operands = splitOperands(rest);
+    return ins;
+}
+
+// Collects the instructions and local labels of each function named in symbols
+std::map<std::string, Function> readFunctions(const std::string& path, const std::set<std::string>& symbols) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    std::map<std::string, Function> functions;
+    Function* current = nullptr;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        if (line[0] != '\t' && line[0] != ' ' && line.back() == ':') {
+            std::string label = line.substr(0, line.size() - 1);
+            if (symbols.count(label)) current = &functions[label];
+            else if (current) current->labels[label] = current->code.size();
+            continue;
+        }
+        if (!current) continue;
+        std::string text = trim(line);
+        if (text == ".cfi_endproc") {
+            current = nullptr;
+        } else if (!text.empty() && text[0] != '.' && text[0] != '#') {
+            current->code.push_back(parseInstruction(text));
+            if (text == "movq\t%rsp, %rbp") current->framePointer = true;
+        }
+    }
+    return functions;
+}
+
+//--------- Classification -------------//
+
+// Arithmetic, compare and blend on floats; the last two letters are ps/pd or ss/sd. Bitwise
+// andps / xorps are left out: scalar code uses them too, for fabs, negation and zeroing.
+const std::string fpOps = "(add|sub|mul|div|sqrt|min|max|rcp|rsqrt|round|hadd|hsub|addsub|"
+                          "cmp[a-z]*|blendv?|dp|fn?m(add|sub)[0-9]*|fmaddsub[0-9]*|fmsubadd[0-9]*)";
+const std::regex packedFp("^" + fpOps + "p[sd]$");
+const std::regex scalarFp("^(" + fpOps + "s[sd]|u?comis[sd])$");
+const std::regex shuffle("^(p?shuf[a-z0-9]*|p?perm[a-z0-9]*|p?unpck[a-z]*|insert[a-z0-9]*|extract[a-z0-9]*|"
+                         "pinsr[a-z]*|pextr[a-z]*|p?broadcast[a-z0-9]*|p?alignr|movhlps|movlhps|movs[lh]dup|"
+                         "movddup|pack[a-z]*|p?compress[a-z]*|p?expand[a-z]*)$");
+const std::regex divide("^(i?div|sqrt)[a-z]*$");
+
+bool isMemory(const std::string& operand) { return operand.find('(') != std::string::npos; }
+
+// A stack slot is addressed off %rsp, or off %rbp when the function keeps a frame pointer;
+// without one %rbp is an ordinary register, e.g. 0(%rbp,%rbx,4) is an array element.
+bool isStack(const std::string& operand, bool framePointer) {
+    return operand.find("(%rsp)") != std::string::npos || (framePointer && operand.find("(%rbp)") != std::string::npos);
+}
+
+struct Mix {
+    int instructions = 0, packed = 0, scalar = 0, loads = 0, stores = 0;
+    int shuffles = 0, gathers = 0, divides = 0, spills = 0;
+};
+
+void classify(const Instruction& ins, bool framePointer, Mix& mix) {
+    const std::string& m = ins.mnemonic;
+    ++mix.instructions;
+    if (m.compare(0, 3, "cvt") == 0) {
+        // conversions: cvtdq2ps / cvttps2dq are packed, cvtsi2ss / cvtss2sd scalar
+        if (m.find("ps") != std::string::npos || m.find("pd") != std::string::npos) ++mix.packed;
+        else if (m.find("ss") != std::string::npos || m.find("sd") != std::string::npos) ++mix.scalar;
+    } else if (std::regex_match(m, packedFp)) {
+        ++mix.packed;
+    } else if (std::regex_match(m, scalarFp)) {
+        ++mix.scalar;
+    }
+    if (std::regex_match(m, shuffle)) ++mix.shuffles;
+    if (m.find("gather") != std::string::npos) ++mix.gathers;
+    if (std::regex_match(m, divide)) ++mix.divides;
+
+    if (m == "pushq" || m == "popq") {
+        ++mix.spills;
+        return;
+    }
+    if (m.compare(0, 3, "lea") == 0 || m.compare(0, 3, "nop") == 0 || m.compare(0, 8, "prefetch") == 0) return;
+    for (size_t o = 0; o < ins.operands.size(); ++o) {
+        if (!isMemory(ins.operands[o])) continue;
+        bool destination = o + 1 == ins.operands.size() && ins.operands.size() > 1;
+        if (destination) ++mix.stores;
+        else ++mix.loads;
+        if (isStack(ins.operands[o], framePointer)) ++mix.spills;
+    }
+}
+
+//--------- Audit -------------//
+
+struct Report {
+    Mix mix;
+    bool hasLoop = false;
+    std::vector<std::string> calls;
+    std::string firstScalar; // first scalar FP instruction in the hot code
+};
+
+Report auditFunction(const Function& fn) {
+    Report report;
+    std::vector<bool> hot(fn.code.size(), false);
+    for (size_t i = 0; i < fn.code.size(); ++i) {
+        const Instruction& ins = fn.code[i];
+        if (ins.mnemonic == "call" || (ins.mnemonic == "jmp" && !ins.operands.empty() && ins.operands[0][0] != '.')) {
+            report.calls.push_back(ins.operands.empty() ? "?" : ins.operands[0]);
+        }
+        bool conditional = ins.mnemonic[0] == 'j' && ins.mnemonic != "jmp";
+        if (!conditional || ins.operands.empty()) continue;
+        auto target = fn.labels.find(ins.operands[0]);
+        if (target == fn.labels.end() || target->second > i) continue;
+        report.hasLoop = true;
+        for (size_t j = target->second; j <= i; ++j) hot[j] = true;
+    }
+    for (size_t i = 0; i < fn.code.size(); ++i) {
+        if (!hot[i]) continue;
+        int scalarBefore = report.mix.scalar;
+        classify(fn.code[i], fn.framePointer, report.mix);
+        if (report.mix.scalar > scalarBefore && report.firstScalar.empty()) report.firstScalar = fn.code[i].text;
+    }
+    return report;
+}
+
+// Prints the instruction mix of every registered kernel and returns the number of failures
+int auditFile(const std::string& path) {
+    std::set<std::string> symbols;
+    for (size_t k = 0; k < kernelCount; ++k) symbols.insert(kernels[k].symbol);
+    std::map<std::string, Function> functions = readFunctions(path, symbols);
+
+    std::cout << "== " << path << std::endl;
+    std::cout << std::left << std::setw(28) << "kernel" << std::right << std::setw(6) << "insns" << std::setw(8)
+              << "packed" << std::setw(8) << "scalar" << std::setw(7) << "loads" << std::setw(8) << "stores"
+              << std::setw(9) << "shuffles" << std::setw(9) << "gathers" << std::setw(10) << "div/sqrt"
+              << std::setw(8) << "spills" << "  verdict" << std::endl;
+    int failures = 0;
+    for (size_t k = 0; k < kernelCount; ++k) {
+        const Kernel& kernel = kernels[k];
+        auto fn = functions.find(kernel.symbol);
+        std::cout << std::left << std::setw(28) << kernel.name << std::right;
+        if (fn == functions.end()) {
+            std::cout << "  FAIL: " << kernel.symbol << " not found (inlined or renamed?)" << std::endl;
+            ++failures;
+            continue;
+        }
+        Report report = auditFunction(fn->second);
+        const Mix& mix = report.mix;
+        std::cout << std::setw(6) << mix.instructions << std::setw(8) << mix.packed << std::setw(8) << mix.scalar
+                  << std::setw(7) << mix.loads << std::setw(8) << mix.stores << std::setw(9) << mix.shuffles
+                  << std::setw(9) << mix.gathers << std::setw(10) << mix.divides << std::setw(8) << mix.spills << "  ";
+        if (!report.hasLoop) {
+            std::cout << "no loop";
+            if (!report.calls.empty()) std::cout << ", calls " << report.calls[0];
+        } else if (kernel.vectorized && mix.scalar > 0) {
+            std::cout << "FAIL: scalar FP in loop (" << report.firstScalar << ")";
+            ++failures;
+        } else if (!kernel.vectorized && mix.packed > 0 && mix.packed >= mix.scalar) {
+            // scalar code can use a packed blend or compare on one value, so require a majority
+            std::cout << "auto-vectorized";
+        } else {
+            std::cout << "ok";
+        }
+        if (report.hasLoop && mix.spills > 0) std::cout << ", spills in loop";
+        std::cout << std::endl;
+    }
+    std::cout << failures << " failure(s)" << std::endl << std::endl;
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: codegen_audit SUITE.s [SUITE.s ...]" << std::endl;
+        return 1;
+    }
+    int failures = 0;
+    try {
+        for (int i = 1; i < argc; ++i) failures += auditFile(argv[i]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return failures ? 1 : 0;
+}